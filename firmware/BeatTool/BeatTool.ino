@@ -22,18 +22,24 @@
 
   Beat Tool generates and processes clock signals. It can be used as a
   voltage-controlled clock multiplier, clock divider, burst generator,
-  or clock generator.
+  clock generator, gate delay or gate lengthener, Euclidean or random rhythm
+  sequencer, or to add swing to a clock.
 
   ----------
   PARAMETERS
   ----------
 
   PARAM 3 - Mode
-    Knob selects between 4 different modes:
+    Knob selects between 9 different modes:
       - Divide Mode
       - Multiply Mode
       - Burst Mode
       - Clock Mode
+      - Swing Mode
+      - Delay Mode
+      - Lengthen Mode
+      - Euclidean Mode
+      - Random Mode
 
   PARAM 2 - Range / Repeat
     Exact function varies depending on mode. See each mode's comment.
@@ -59,6 +65,19 @@
 // Hysteresis amount for discrete knobs
 #define HYSTERESIS_AMT 5
 
+// Everything that generates or follows gates runs in the timer interrupt, so
+// output edges land within one tick (100 us) of where they should.
+#define TIMER_RATE JNTUB::SAMPLE_RATE_10_KHZ
+#define TICKS_PER_MS (TIMER_RATE / 1000)
+
+/**
+ * FastClock rate for a period in milliseconds. **SLOW** (divides)
+ */
+uint32_t msToRate(uint16_t periodMs)
+{
+  return (UINT32_MAX / periodMs) / TICKS_PER_MS;
+}
+
 #if defined(__AVR_ATmega328P__) || defined(__AVR_ATmega328__)
 #define DEBUGINIT() Serial.begin(115200)
 #define DEBUG(...) Serial.print(__VA_ARGS__)
@@ -183,38 +202,79 @@ const Range CLOCK_RANGES_MUSICAL[] = {
 #define CLOCK_RANGES      CLOCK_RANGES_PRECISE
 #define NUM_CLOCK_RANGES  NELEM(CLOCK_RANGES)
 
-class ClockMode {
+/**
+ * Clock period for a rate knob reading within one of the CLOCK_RANGES.
+ */
+uint16_t clockPeriod(uint16_t rangeAndRate)
+{
+  Range range = CLOCK_RANGES[rangeAndRate >> 10];
+  return map(rangeAndRate & 0x3FF, 0, 1023, range.low, range.high);
+}
+
+/**
+ * Clock rate for a rate knob reading within one of the CLOCK_RANGES.
+ * Takes both packed into one value (range index above the 10-bit reading),
+ * so that a Param can tell when either changes.
+ */
+uint32_t clockRate(uint16_t rangeAndRate)
+{
+  return msToRate(clockPeriod(rangeAndRate));
+}
+
+/**
+ * Base of every mode class. Only one mode runs at a time, so the modes share
+ * their SRAM (see Modes below), and setMode() builds the one it switches to
+ * in place. Not every AVR core declares placement new, so it's done here.
+ */
+struct ModeState {
+  static inline void *operator new(size_t, void *where)
+  {
+    return where;
+  }
+};
+
+class ClockMode : public ModeState {
 private:
-  JNTUB::DiscreteKnob rangeKnob;
-  JNTUB::Clock clock;
+  JNTUB::DiscreteKnob<NUM_CLOCK_RANGES, HYSTERESIS_AMT> rangeKnob;
+  JNTUB::FastClock clock;
   JNTUB::EdgeDetector sync;
 
   Range curRange;
+  JNTUB::Param<uint16_t, uint32_t> rate;
 
 public:
   ClockMode()
-    : rangeKnob(NUM_CLOCK_RANGES, HYSTERESIS_AMT)
+    : clock(TIMER_RATE),
+      rate(clockRate)
   {}
 
-  void setup()
+  // Call with interrupts disabled.
+  void reset()
   {
     clock.start();
   }
 
-  bool loop(uint32_t tMillis, uint16_t rateIn, uint16_t rangeIn, bool syncIn)
+  void update(uint16_t rateIn, uint16_t rangeIn)
   {
     rangeKnob.update(rangeIn);
-    clock.update(tMillis);
-    sync.update(syncIn);
-
-    if (sync.isRising())
-      clock.sync();
 
     curRange = CLOCK_RANGES[rangeKnob.getValue()];
 
-    uint16_t rate = map(rateIn, 0, 1023, curRange.low, curRange.high);
+    if (rate.update(((uint16_t)rangeKnob.getValue() << 10) | rateIn)) {
+      noInterrupts();
+      clock.setRate(rate.getValue());
+      interrupts();
+    }
+  }
 
-    clock.setPeriod(rate);
+  // Call from the timer interrupt.
+  inline bool tick(bool syncIn)
+  {
+    clock.tick();
+    sync.update(syncIn);
+
+    if (sync.isRising())
+      clock.sync();
 
     return clock.getState();
   }
@@ -224,7 +284,7 @@ public:
     DEBUG(">>>CLOCK MODE");
 
     DEBUG(", rate=");
-    DEBUG(clock.getPeriod(), DEC);
+    DEBUG(rate.getValue(), DEC);
 
     DEBUG(", knob=");
     DEBUG(rangeKnob.getValue(), DEC);
@@ -270,7 +330,7 @@ const uint8_t BURST_REPEAT_OPTIONS[] = {
   9, 10, 11, 12, 13, 14, 15, 16
 };
 
-const uint16_t BURST_RATE_CURVE[] = {
+const uint16_t BURST_RATE_CURVE[] PROGMEM = {
   1000,  // 1/16 note at 15 bpm
   500,  // 1/16 note at 30 bpm
   250,   // 1/16 note at 60 bpm
@@ -282,51 +342,62 @@ const uint16_t BURST_RATE_CURVE[] = {
   62,    // 1/16 note at 240 bpm
 };
 
-class BurstMode {
+class BurstMode : public ModeState {
 private:
-  JNTUB::DiscreteKnob repeatKnob;
-  JNTUB::CurveKnob<uint16_t> rateKnob;
-  JNTUB::Clock clock;
+  JNTUB::DiscreteKnob<NELEM(BURST_REPEAT_OPTIONS), HYSTERESIS_AMT> repeatKnob;
+  JNTUB::CurveKnob<uint16_t, JNTUB::ProgmemStorage> rateKnob;
+  JNTUB::FastClock clock;
   JNTUB::EdgeDetector trigger;
   uint8_t numGatesSent;
+  volatile uint8_t repeats;
 
 public:
   BurstMode()
-    : repeatKnob(NELEM(BURST_REPEAT_OPTIONS), HYSTERESIS_AMT),
-      rateKnob(BURST_RATE_CURVE, NELEM(BURST_RATE_CURVE))
-  {}
+    : rateKnob(BURST_RATE_CURVE, NELEM(BURST_RATE_CURVE)),
+      clock(TIMER_RATE)
+  {
+    repeats = BURST_REPEAT_OPTIONS[0];
+  }
 
-  void setup()
+  // Call with interrupts disabled.
+  void reset()
   {
     numGatesSent = 0;
-    clock.sync(128);  // set clock low
+    clock.stop();
+    clock.sync(clock.getDuty());  // set clock low
   }
 
-  bool loop(uint32_t tMillis, uint16_t rateIn, uint16_t repeatsIn, bool trgIn)
+  void update(uint16_t rateIn, uint16_t repeatsIn)
   {
     rateKnob.update(rateIn);
     repeatKnob.update(repeatsIn);
-    clock.update(tMillis);
-    trigger.update(trgIn);
 
     // Update rate
-    uint16_t periodMicros = rateKnob.getValue();
-    clock.setPeriod(periodMicros);
+    if (rateKnob.valueChanged()) {
+      uint32_t rate = msToRate(rateKnob.getValue());
+      noInterrupts();
+      clock.setRate(rate);
+      interrupts();
+    }
+
+    repeats = BURST_REPEAT_OPTIONS[repeatKnob.getValue()];
+  }
+
+  // Call from the timer interrupt.
+  inline bool tick(bool trgIn)
+  {
+    trigger.update(trgIn);
 
-    // Start a new burst on trigger
     if (trigger.isRising()) {
+      // Start a new burst
       numGatesSent = 0;
       clock.sync();
       clock.start();
-    }
-
-    if (clock.isFalling())
-      ++numGatesSent;
-
-    // Check if burst done
-    uint8_t repeats = BURST_REPEAT_OPTIONS[repeatKnob.getValue()];
-    if (numGatesSent >= repeats) {
-      clock.stop();
+    } else {
+      clock.tick();
+      // Check if burst done
+      if (clock.isFalling() && ++numGatesSent >= repeats)
+        clock.stop();
     }
 
     return clock.getState();
@@ -337,10 +408,10 @@ public:
     DEBUG(">>>BURST MODE");
 
     DEBUG(", rate=");
-    DEBUG(clock.getPeriod(), DEC);
+    DEBUG(rateKnob.getValue(), DEC);
 
     DEBUG(", repeats=");
-    DEBUG(BURST_REPEAT_OPTIONS[repeatKnob.getValue()], DEC);
+    DEBUG(repeats, DEC);
 
     DEBUG('\n');
   }
@@ -355,15 +426,14 @@ public:
  * The GATE/TRG input acts as a clock signal input, and OUT is derived by
  * dividing or multiplying the incoming clock.
  *
- * Clock division with whole number divisors is exact; transitions are
- * synchronous with incoming rising and falling clock edges (well, as
- * synchronous as it can be, limited by the MCU's internal system clock).
- *
- * Clock division with fractional divisors, or clock multiplication with any
- * multiplier, is approximate; the perceived clock speed is calculated in real
- * time and may become briefly inaccurate if the actual clock speed changes or
- * there is inconsistency / swing. Perhaps you can use this to your creative
- * advantage in your patches :-)
+ * For a multiplier of N/M, every M periods of the incoming clock span
+ * exactly N periods of OUT, and OUT's edges land on the incoming clock's
+ * rising edges wherever the two coincide (e.g. every edge of a whole number
+ * division, every edge of the input for any multiplication). Other edges are
+ * placed using the measured period of the incoming clock, so they may land
+ * briefly early or late if the clock speed changes or there is
+ * inconsistency / swing. OUT never runs ahead of the incoming clock though;
+ * it waits for the next incoming edge instead.
  *
  * ------------------
  *     PARAMETERS
@@ -415,262 +485,717 @@ const Multiplier MULTIPLIERS[][8] = {
 };
 
 /**
- * Uses the phase of an input clock to derive a multiplied
- * version of the input clock.
+ * =============================================================================
+ *                                 SWING MODE
+ * =============================================================================
+ *
+ * Swing mode multiplies or divides the clock at GATE/TRG (like Multiply and
+ * Divide modes) and delays every second gate it generates by a fraction of
+ * the generated clock's period.
+ *
+ * The delay is measured against the generated clock's phase, so it lands
+ * to within a tick (100 us) of exact at any tempo. Whenever the generated
+ * clock has a whole number of pairs of gates per incoming clock period (or
+ * per M periods for a ratio of N/M), the first gate of each pair is on the
+ * incoming clock's beat.
+ *
+ * Swing only applies to a clock at GATE/TRG. Clock mode's knobs are all
+ * taken (Rate, Range, and Mode on PARAM 3), so it has nowhere to set a swing
+ * amount; swing a generated clock by running it through a second module in
+ * Swing mode.
+ *
+ * ------------------
+ *     PARAMETERS
+ * ------------------
+ *
+ * PARAM 1: Rate
+ *    Selects the multiplier from SWING_MULTIPLIERS:
+ *      /4    /3    /2    x1    x2    x3    x4
  *
- * Implements a Clock-like interface so it can be used as input to
- * another ClockMultiplier or ClockDivider.
+ * PARAM 2: Swing
+ *    Delays every second gate by 0 (straight) up to half of a period
+ *    (75% swing: a dotted rhythm).
+ *
+ * GATE/TRG: Clock In
+ */
+
+const Multiplier SWING_MULTIPLIERS[] = {
+  {1, 4}, {1, 3}, {1, 2}, {1, 1}, {2, 1}, {3, 1}, {4, 1}
+};
+
+/**
+ * Divide, Multiply and Swing modes.
  */
-template<typename ClockT>
-class ClockMultiplier {
+class MultiplyMode : public ModeState {
 private:
-  const ClockT *mClkIn;
-  uint8_t mMult;
-  uint8_t mMultNext;
-  uint8_t mCurPhase;
-  bool mPrevState;
+  JNTUB::DiscreteKnob<NELEM(MULTIPLIERS[0]), HYSTERESIS_AMT> rateKnob;
+  JNTUB::DiscreteKnob<NELEM(MULTIPLIERS), HYSTERESIS_AMT> rangeKnob;
+  JNTUB::DiscreteKnob<NELEM(SWING_MULTIPLIERS), HYSTERESIS_AMT> swingRateKnob;
 
-public:
-  ClockMultiplier(const ClockT *clkIn)
-  {
-    mClkIn = clkIn;
-  }
+  // Measures the period and duty cycle of the input clock...
+  JNTUB::FastClockApproximator clockIn;
+  // ...and runs OUT at the selected ratio of it, locked to its edges.
+  JNTUB::RatioClock clockOut;
 
-  void setMultiplier(uint8_t mult)
-  {
-    // copy this to mMult at start of next input period
-    mMultNext = mult;
-  }
-  void initialize()
+  Multiplier multiplier;
+  // Input clock period (UQ24.8 ticks) and duty that OUT was last set up for
+  uint32_t inputHigh;
+  uint32_t inputLow;
+  uint32_t inputDuty;
+
+  // Every second gate is high from swingStart to swingEnd into its period.
+  // A swingStart of 0 means no swing: every gate is just clockOut's.
+  volatile uint32_t swingStart;
+  volatile uint32_t swingEnd;
+  // Whether the current gate is the second of a pair
+  bool secondGate;
+
+  // **SLOW** (divides) if the multiplier, swing or input clock changed
+  void setMultiplier(Multiplier newMultiplier, uint32_t swing)
   {
-    mMult = mMultNext;
-    mCurPhase = 0;
-    mPrevState = 0;
+    uint32_t high, low;
+    clockIn.getPeriod(&high, &low);
+    bool newRatio = newMultiplier.numerator != multiplier.numerator ||
+                    newMultiplier.denominator != multiplier.denominator;
+    bool newInput = high != inputHigh || low != inputLow;
+    if (!newRatio && !newInput && swing == swingStart)
+      return;
+
+    if (newRatio) {
+      multiplier = newMultiplier;
+      clockOut.setRatio(multiplier.numerator, multiplier.denominator);
+    }
+
+    if (newInput) {
+      inputHigh = high;
+      inputLow = low;
+      uint32_t inputRate;
+      clockIn.calculateRateAndDuty(&inputRate, &inputDuty);
+      clockOut.setInputRate(inputRate);
+      clockOut.setDuty(inputDuty);
+    }
+
+    // The delayed gate has to end before the next one starts. Cut it off
+    // halfway through what's left of its period if need be, so the two
+    // don't merge.
+    uint32_t end = 0;
+    if (swing > 0) {
+      end = swing + inputDuty;
+      uint32_t latestEnd = swing + ((UINT32_MAX - swing) >> 1);
+      if (end < swing || end > latestEnd)
+        end = latestEnd;
+    }
+    noInterrupts();
+    swingStart = swing;
+    swingEnd = end;
+    interrupts();
   }
-  uint8_t getDuty() const
+
+public:
+  MultiplyMode()
+    : clockIn(TIMER_RATE)
   {
-    return mClkIn->getDuty();
+    multiplier = {1, 1};
+    // Not a real period, so the first update() sets everything up.
+    inputHigh = UINT32_MAX;
+    inputLow = UINT32_MAX;
+    inputDuty = (uint32_t)1 << 31;
+    swingStart = 0;
+    swingEnd = 0;
   }
-  uint8_t getPhase() const
+
+  // Call with interrupts disabled.
+  void reset()
   {
-    return mCurPhase;
+    clockOut.reset();
+    secondGate = true;
   }
-  bool getState() const
+
+  void update(uint16_t rateIn, uint16_t rangeIn, bool divide)
   {
-    return mCurPhase < mClkIn->getDuty();
+    rateKnob.update(rateIn);
+    rangeKnob.update(rangeIn);
+
+    // Select the desired multiplier
+    uint8_t range = rangeKnob.getValue();
+    uint8_t rate = rateKnob.getValue();
+    Multiplier newMultiplier = MULTIPLIERS[range][rate];
+    if (divide)
+      newMultiplier = newMultiplier.reciprocal();
+
+    setMultiplier(newMultiplier, 0);
   }
-  bool isRising() const
+
+  void updateSwing(uint16_t rateIn, uint16_t swingIn)
   {
-    return !mPrevState && getState();
+    swingRateKnob.update(rateIn);
+
+    // 0 to 1023 -> 0 to just under half a period
+    uint32_t swing = (uint32_t)swingIn << 21;
+    setMultiplier(SWING_MULTIPLIERS[swingRateKnob.getValue()], swing);
   }
-  bool isFalling() const
+
+  // Call from the timer interrupt.
+  inline bool tick(bool clkIn)
   {
-    return mPrevState && !getState();
+    clockIn.tick(clkIn);
+    clockOut.tick(clockIn.isRising());
+
+    if (swingStart == 0)
+      return clockOut.getState();
+
+    if (clockOut.isRising()) {
+      secondGate = !secondGate;
+      // Line the pairs back up with the incoming clock whenever a frame is
+      // a whole number of pairs.
+      if (clockOut.isStartOfFrame() && !(clockOut.getNumerator() & 1))
+        secondGate = false;
+    }
+
+    if (secondGate) {
+      uint32_t phase = clockOut.getPhase();
+      return phase >= swingStart && phase < swingEnd;
+    }
+    return clockOut.getState();
   }
 
-  // Do not call until clkIn has been updated.
-  void update()
+  void debug()
   {
-    mPrevState = getState();
-    mCurPhase = (mClkIn->getPhase() * mMult) % JNTUB::Clock::PHASE_MAX;
-    if (mClkIn->isRising())
-      mMult = mMultNext;
+    DEBUG(">>>MULTIPLY MODE");
+
+    DEBUG(", multiplier=");
+    DEBUG(multiplier.numerator, DEC);
+    DEBUG('/');
+    DEBUG(multiplier.denominator, DEC);
+
+    noInterrupts();
+    uint32_t inputTicks = clockIn.getHighTicks() + clockIn.getLowTicks();
+    uint32_t phase = clockOut.getPhase();
+    interrupts();
+
+    DEBUG(", estimatedPeriod=");
+    DEBUG(inputTicks, DEC);
+
+    DEBUG(", out.phase=");
+    DEBUG(phase, DEC);
+
+    DEBUG('\n');
   }
 };
 
 /**
- * Uses the edges of an input clock to derive a divided
- * version of the input clock.
+ * =============================================================================
+ *                           GATE DELAY / LENGTHEN MODE
+ * =============================================================================
+ *
+ * Delay mode repeats the gates at GATE/TRG at OUT a set time later, with
+ * their lengths unchanged. Lengthen mode starts each gate at OUT as soon as
+ * it starts at GATE/TRG, but holds it high for a set time after it ends.
+ *
+ * Each edge is timestamped as it comes in and its output edge scheduled, to
+ * the tick (100 us), on a queue of pending edges. Any number of gates may be
+ * in flight at once, up to GATE_QUEUE_SIZE edges (16 gates, in Delay mode).
+ * Beyond that, the newest gate is merged into the one before it rather than
+ * dropped, so OUT is still high wherever it should be. Lengthen mode merges
+ * gates that overlap once lengthened.
+ *
+ * ------------------
+ *     PARAMETERS
+ * ------------------
+ *
+ * PARAM 1: Time
+ *    Delay or lengthen time, from 1 ms to 6 s. Follows a piecewise-linear
+ *    exponential approximation function defined by GATE_TIME_CURVE.
+ *
+ * PARAM 2: Unused
+ *
+ * GATE/TRG: Gate In
+ */
+
+// Delay / lengthen times in milliseconds. At most 6553 (65535 ticks).
+const uint16_t GATE_TIME_CURVE[] PROGMEM = {
+  1,
+  10,
+  30,
+  60,
+  125,
+  250,
+  500,
+  1000,
+  2000,
+  4000,
+  6000,
+};
+
+#define GATE_QUEUE_SIZE 32
+
+/**
+ * Queue of pending output edges.
  *
- * Implements a Clock-like interface so it can be used as input to
- * another ClockMultiplier or ClockDivider.
+ * Each edge is stored as the number of ticks between it and the edge before
+ * it, so it takes 2 bytes and only the one at the head needs counting down.
+ * At most one edge comes due per tick; one that would land on the same tick
+ * as the edge before it comes a tick late rather than being lost.
  */
-template<typename ClockT>
-class ClockDivider {
-public:
-  const ClockT *mClkIn;
-  uint8_t mDiv;
-  uint8_t mDivNext;
-  // How many edges have occurred in the input clock since the last edge
-  // of the divided clock? Flip-flop the output every mDiv edges.
-  uint8_t mNumEdges;
-  uint8_t mCurPhase;
-  bool mPrevState;
+template<uint8_t N>
+class EdgeQueue {
+private:
+  static_assert((N & (N - 1)) == 0, "queue size must be a power of two");
+
+  uint16_t mGaps[N];
+  uint8_t mHead;
+  uint8_t mCount;
+  // Ticks until the edge at the head, and the one at the tail, are due.
+  uint16_t mHeadWait;
+  uint16_t mTailWait;
 
 public:
-  ClockDivider(const ClockT *clkIn)
+  EdgeQueue()
   {
-    mClkIn = clkIn;
+    clear();
   }
 
-  void setDivisor(uint8_t div)
+  void clear()
   {
-    // copy this to mDiv at start of next input period
-    mDivNext = div;
+    mHead = 0;
+    mCount = 0;
+    mHeadWait = 0;
+    mTailWait = 0;
   }
-  void initialize()
+
+  inline bool isEmpty() const
   {
-    mDiv = mDivNext;
-    mCurPhase = 0;
-    mPrevState = 0;
-    mNumEdges = mDiv * 2;
+    return mCount == 0;
   }
-  uint8_t getDuty() const
+
+  inline bool isFull() const
   {
-    return mClkIn->getDuty();
+    return mCount == N;
   }
-  uint8_t getPhase() const
+
+  /**
+   * Schedule an edge delay ticks from now (at least 1). Edges must be pushed
+   * in the order they are to come due; one scheduled before the tail comes
+   * right after it instead. Returns false if the queue is full.
+   */
+  inline bool push(uint16_t delay)
   {
-    return mCurPhase;
+    if (isFull())
+      return false;
+    uint16_t gap = delay;
+    if (mCount == 0)
+      mHeadWait = mTailWait = 0;
+    else if (delay > mTailWait)
+      gap = delay - mTailWait;
+    else
+      gap = 0;
+    mGaps[(mHead + mCount) & (N-1)] = gap;
+    ++mCount;
+    mTailWait += gap;
+    if (mCount == 1)
+      mHeadWait = gap;
+    return true;
   }
-  bool getState() const
+
+  /**
+   * Unschedule the edge most recently pushed.
+   */
+  inline void dropLast()
   {
-    return mCurPhase < mClkIn->getDuty();
+    if (mCount == 0)
+      return;
+    --mCount;
+    if (mCount == 0)
+      mTailWait = 0;
+    else
+      mTailWait -= mGaps[(mHead + mCount) & (N-1)];
   }
-  bool isRising() const
+
+  /**
+   * Advance one tick. Returns whether an edge came due (and was removed).
+   */
+  inline bool tick()
   {
-    return !mPrevState && getState();
+    if (mTailWait)
+      --mTailWait;
+    if (mCount == 0)
+      return false;
+    if (mHeadWait && --mHeadWait)
+      return false;
+    mHead = (mHead + 1) & (N-1);
+    --mCount;
+    mHeadWait = mGaps[mHead];
+    return true;
   }
-  bool isFalling() const
+};
+
+/**
+ * Gate Delay and Lengthen modes.
+ */
+class GateMode : public ModeState {
+private:
+  JNTUB::CurveKnob<uint16_t, JNTUB::ProgmemStorage> timeKnob;
+  JNTUB::EdgeDetector gate;
+  EdgeQueue<GATE_QUEUE_SIZE> edges;
+
+  // Delay / lengthen time in ticks
+  volatile uint16_t time;
+
+  // Delay mode: level of OUT, and what it will be once every edge queued so
+  // far is out. Edges alternate, so each one that comes due toggles OUT.
+  bool output;
+  bool queuedHigh;
+
+public:
+  GateMode()
+    : timeKnob(GATE_TIME_CURVE, NELEM(GATE_TIME_CURVE))
   {
-    return mPrevState && !getState();
+    time = TICKS_PER_MS;
   }
 
-  // Do not call until clkIn has been updated.
-  void update()
+  // Call with interrupts disabled.
+  void reset()
   {
-    mPrevState = getState();
+    edges.clear();
+    output = false;
+    queuedHigh = false;
+  }
 
-    if (mClkIn->isRising() || mClkIn->isFalling()) {
-      ++mNumEdges;
+  void update(uint16_t timeIn)
+  {
+    timeKnob.update(timeIn);
+    if (timeKnob.valueChanged()) {
+      uint16_t ticks = timeKnob.getValue() * TICKS_PER_MS;
+      noInterrupts();
+      time = ticks;
+      interrupts();
     }
+  }
 
-    if (mNumEdges >= mDiv * 2) {
-      mNumEdges = 0;
-      mDiv = mDivNext;
+  // Call from the timer interrupt.
+  inline bool tickDelay(bool gateIn)
+  {
+    if (edges.tick())
+      output = !output;
+
+    gate.update(gateIn);
+    if (gate.isRising() && !queuedHigh) {
+      queuedHigh = true;
+      // Out of room: cancel the last gate's fall instead, merging this gate
+      // into it.
+      if (!edges.push(time))
+        edges.dropLast();
+    } else if (gate.isFalling() && queuedHigh) {
+      queuedHigh = false;
+      // Out of room (so the tail is this gate's rise): merge this gate into
+      // the last one, and end that where this one should.
+      if (edges.isFull()) {
+        edges.dropLast();
+        edges.dropLast();
+      }
+      edges.push(time);
     }
 
-    uint8_t phaseAccumulatedFromEdges =
-        mNumEdges * JNTUB::Clock::PHASE_MAX / mDiv / 2;
-    uint8_t currentPhaseInInputHalfPeriod =
-        mClkIn->getPhase() % (JNTUB::Clock::PHASE_MAX / 2);
-    mCurPhase =
-      phaseAccumulatedFromEdges + (currentPhaseInInputHalfPeriod / mDiv);
+    return output;
+  }
+
+  // Call from the timer interrupt.
+  inline bool tickLengthen(bool gateIn)
+  {
+    edges.tick();
+
+    // OUT stays high until every queued fall is out, so when there's no room
+    // for another, the latest one can just be moved later.
+    gate.update(gateIn);
+    if (gate.isFalling() && !edges.push(time)) {
+      edges.dropLast();
+      edges.push(time);
+    }
+
+    return gateIn || !edges.isEmpty();
+  }
+
+  void debug()
+  {
+    DEBUG(">>>GATE MODE");
+
+    DEBUG(", time=");
+    DEBUG(timeKnob.getValue(), DEC);
+
+    DEBUG('\n');
   }
 };
 
-class MultiplyMode {
+/**
+ * =============================================================================
+ *                               EUCLIDEAN MODE
+ * =============================================================================
+ *
+ * Euclidean mode steps through a Euclidean rhythm of EUCLID_STEPS steps,
+ * advancing one step per gate at GATE/TRG, and passes through the gates that
+ * land on a hit. A Euclidean rhythm spreads its hits over the steps as
+ * evenly as possible, e.g. 3 hits in 8 steps is x..x..x.
+ *
+ * The pattern is only worked out when a knob moves to a new step, so
+ * following it costs a shift and a bit test per gate.
+ *
+ * ------------------
+ *     PARAMETERS
+ * ------------------
+ *
+ * PARAM 1: Hits
+ *    Number of hits in the pattern, from 0 to EUCLID_STEPS.
+ *
+ * PARAM 2: Rotation
+ *    Rotates the pattern later by 0 to EUCLID_STEPS-1 steps.
+ *
+ * GATE/TRG: Clock In
+ */
+
+// Length of the pattern, up to 32
+#define EUCLID_STEPS 16
+
+/**
+ * Euclidean rhythm of some hits over EUCLID_STEPS steps, rotated later by
+ * some steps, as a mask with the first step in bit 0. **SLOW**
+ *
+ * Step i is a hit when (i * hits) % EUCLID_STEPS < hits, which is the same
+ * pattern Bjorklund's algorithm gives (up to rotation), starting on a hit.
+ */
+uint32_t euclideanPattern(uint8_t hits, uint8_t rotation)
+{
+  // (i * hits) % EUCLID_STEPS, starting from i = -rotation
+  uint8_t bucket = 0;
+  for (uint8_t i = rotation; i < EUCLID_STEPS; ++i) {
+    bucket += hits;
+    if (bucket >= EUCLID_STEPS)
+      bucket -= EUCLID_STEPS;
+  }
+
+  // Shift the steps in from the top, so that the first ends up in bit 0.
+  uint32_t pattern = 0;
+  for (uint8_t i = 0; i < EUCLID_STEPS; ++i) {
+    pattern >>= 1;
+    if (bucket < hits)
+      pattern |= 1UL << (EUCLID_STEPS - 1);
+    bucket += hits;
+    if (bucket >= EUCLID_STEPS)
+      bucket -= EUCLID_STEPS;
+  }
+  return pattern;
+}
+
+class EuclideanMode : public ModeState {
 private:
-  JNTUB::DiscreteKnob rateKnob;
-  JNTUB::DiscreteKnob rangeKnob;
-
-  // Keep an internal running clock and continually set its period
-  // to what we think the period of the input clock is.
-  JNTUB::Clock clockFollower;
-  JNTUB::EdgeDetector clkEdge;
-  JNTUB::Stopwatch periodTimer;
-
-  // All possible fractional multipliers/divisors are accomplished using a
-  // combination of one clock multiplier and one clock divider.
-  // The multiplier multiplies the input clock by the numerator,
-  // and the divider divides the resulting signal by the denominator.
-  using MultT = ClockMultiplier<JNTUB::Clock>;
-  using DivT = ClockDivider<MultT>;
-  MultT clkMultiplier;
-  DivT clkDivider;
+  JNTUB::DiscreteKnob<EUCLID_STEPS + 1, HYSTERESIS_AMT> hitsKnob;
+  JNTUB::DiscreteKnob<EUCLID_STEPS, HYSTERESIS_AMT> rotationKnob;
+  JNTUB::EdgeDetector clock;
 
-  Multiplier multiplier;
+  // Set from loop(), and picked up by the timer interrupt at the next gate.
+  volatile uint32_t pattern;
+  volatile bool patternChanged;
 
-  bool initialized;
+  // Pattern from the current step onwards, current step in bit 0
+  uint32_t stepsLeft;
+  uint8_t step;
 
 public:
-  MultiplyMode()
-    : rateKnob(NELEM(MULTIPLIERS[0]), HYSTERESIS_AMT),
-      rangeKnob(NELEM(MULTIPLIERS), HYSTERESIS_AMT),
-      clkMultiplier(&clockFollower),
-      clkDivider(&clkMultiplier)
-  {}
+  EuclideanMode()
+  {
+    pattern = 0;
+  }
 
-  void setup()
+  // Call with interrupts disabled.
+  void reset()
   {
-    multiplier = {1, 1};
+    step = EUCLID_STEPS - 1;
+    stepsLeft = 0;
+    patternChanged = true;
+  }
+
+  void update(uint16_t hitsIn, uint16_t rotationIn)
+  {
+    hitsKnob.update(hitsIn);
+    rotationKnob.update(rotationIn);
+
+    if (hitsKnob.valueChanged() || rotationKnob.valueChanged()) {
+      uint32_t newPattern = euclideanPattern(
+          hitsKnob.getValue(), rotationKnob.getValue());
+      noInterrupts();
+      pattern = newPattern;
+      patternChanged = true;
+      interrupts();
+    }
+  }
+
+  // Call from the timer interrupt.
+  inline bool tick(bool clkIn)
+  {
+    clock.update(clkIn);
+
+    if (clock.isRising()) {
+      if (patternChanged) {
+        // Rare, so the variable shift is fine.
+        patternChanged = false;
+        step = (step + 1 < EUCLID_STEPS) ? step + 1 : 0;
+        stepsLeft = pattern >> step;
+      } else if (++step < EUCLID_STEPS) {
+        stepsLeft >>= 1;
+      } else {
+        step = 0;
+        stepsLeft = pattern;
+      }
+    }
 
-    initialized = false;
+    return clkIn && (stepsLeft & 1);
   }
 
-  bool loop(
-      uint32_t time, uint16_t rateIn, uint16_t rangeIn, bool clkIn, bool divide)
+  void debug()
   {
-    rateKnob.update(rateIn);
-    rangeKnob.update(rangeIn);
-    clockFollower.update(time);
-    clkEdge.update(clkIn);
-    periodTimer.update(time);
+    DEBUG(">>>EUCLIDEAN MODE");
 
-    // Select the desired multiplier
-    uint8_t range = rangeKnob.getValue();
-    uint8_t rate = rateKnob.getValue();
-    multiplier = MULTIPLIERS[range][rate];
-    if (divide)
-      multiplier = multiplier.reciprocal();
+    DEBUG(", hits=");
+    DEBUG(hitsKnob.getValue(), DEC);
 
-    clkMultiplier.setMultiplier(multiplier.numerator);
-    clkDivider.setDivisor(multiplier.denominator);
+    DEBUG(", rotation=");
+    DEBUG(rotationKnob.getValue(), DEC);
 
-    if (!initialized) {
-      clkMultiplier.initialize();
-      clkDivider.initialize();
-      initialized = true;
-    }
+    DEBUG(", pattern=");
+    DEBUG(pattern, BIN);
 
-    // Sync the clock follower up on every clock transition
-    if (clkEdge.isRising()) {
-      // Update period estimate and reset timer
-      clockFollower.setPeriod(periodTimer.getTime());
-      periodTimer.reset();
-      clockFollower.sync(0);
-    } else if (clkEdge.isFalling()) {
-      clockFollower.sync(clockFollower.getDuty());
-    }
+    DEBUG('\n');
+  }
+};
 
-    // If divide mode, and if the divisor is a whole number,
-    // then stop the clock follower from running, and solely rely
-    // on the clock edge transitions. If the clock follower keeps running,
-    // it could outpace the actual incoming clock edges and lead to
-    // inexact clock division.
-    if (divide && multiplier.numerator == 1)
-      clockFollower.stop();
-    else
-      clockFollower.start();
+/**
+ * =============================================================================
+ *                                 RANDOM MODE
+ * =============================================================================
+ *
+ * Random mode passes each gate at GATE/TRG through with a voltage-controlled
+ * probability.
+ *
+ * It can also loop: roll the dice once for each of N steps, and then keep
+ * replaying those rolls, one step per gate. Each step remembers the random
+ * number it rolled rather than whether it passed, so changing the
+ * probability adds or removes hits without scrambling the rest of the
+ * pattern. Selecting another loop length (or Free, and back) rolls a new
+ * pattern.
+ *
+ * ------------------
+ *     PARAMETERS
+ * ------------------
+ *
+ * PARAM 1: Probability
+ *    Chance of each gate (or step) passing, from never to always.
+ *
+ * PARAM 2: Loop
+ *    Free (a new roll for every gate), or the length of the looping pattern,
+ *    from RANDOM_LOOP_LENGTHS.
+ *
+ * GATE/TRG: Clock In
+ */
+
+// 0 is Free
+const uint8_t RANDOM_LOOP_LENGTHS[] = {
+  0, 2, 3, 4, 5, 6, 8, 12, 16
+};
+
+#define RANDOM_MAX_STEPS 16
+
+class RandomMode : public ModeState {
+private:
+  JNTUB::DiscreteKnob<NELEM(RANDOM_LOOP_LENGTHS), HYSTERESIS_AMT> loopKnob;
+  JNTUB::EdgeDetector clock;
+
+  // Used in the timer interrupt, for Free mode...
+  JNTUB::Random rng;
+  // ...and in loop(), for rolling patterns. This one is advanced every loop,
+  // so each pattern depends on exactly when it was asked for.
+  JNTUB::Random patternRng;
 
-    clkMultiplier.update();
-    clkDivider.update();
+  // Rolls of each step of the looping pattern
+  uint8_t steps[RANDOM_MAX_STEPS];
+  volatile uint8_t length;
+  uint8_t step;
 
-    return clkDivider.getState();
+  // A gate passes when its roll (0 to 255) is below this (0 to 256).
+  volatile uint16_t probability;
+  bool pass;
+
+public:
+  // Seeded differently every time (see setMode()), so Free mode doesn't
+  // play the same sequence after every power-up.
+  RandomMode(uint16_t seed)
+    : rng(seed),
+      patternRng(seed ^ 0x1D2B)
+  {
+    length = 0;
+    probability = 128;
   }
 
-  void debug()
+  // Call with interrupts disabled.
+  void reset()
   {
-    DEBUG(">>>MULTIPLY MODE");
+    step = 0;
+    pass = false;
+  }
 
-    DEBUG(", multiplier=");
-    DEBUG(multiplier.numerator, DEC);
-    DEBUG('/');
-    DEBUG(multiplier.denominator, DEC);
+  void update(uint16_t probabilityIn, uint16_t loopIn)
+  {
+    patternRng.next();
+    loopKnob.update(loopIn);
+
+    if (loopKnob.valueChanged()) {
+      uint8_t newLength = RANDOM_LOOP_LENGTHS[loopKnob.getValue()];
+      // Out of the timer interrupt's way while the steps are rewritten
+      noInterrupts();
+      length = 0;
+      interrupts();
+      for (uint8_t i = 0; i < newLength; ++i)
+        steps[i] = patternRng.nextByte();
+      noInterrupts();
+      length = newLength;
+      step = 0;
+      interrupts();
+    }
 
-    DEBUG(", estimatedPeriod=");
-    DEBUG(clockFollower.getPeriod(), DEC);
+    // 0 to 1023 -> 0 to 256
+    uint16_t newProbability = ((uint32_t)probabilityIn * 257) >> 10;
+    noInterrupts();
+    probability = newProbability;
+    interrupts();
+  }
 
-    DEBUG(rateKnob.getValue(), DEC);
+  // Call from the timer interrupt.
+  inline bool tick(bool clkIn)
+  {
+    clock.update(clkIn);
+
+    if (clock.isRising()) {
+      uint8_t roll;
+      if (length == 0) {
+        roll = rng.nextByte();
+      } else {
+        roll = steps[step];
+        if (++step >= length)
+          step = 0;
+      }
+      pass = roll < probability;
+    }
 
-    DEBUG(", follower.phase=");
-    DEBUG(clockFollower.getPhase(), DEC);
+    return clkIn && pass;
+  }
 
-    DEBUG(", clkDiv.phase=");
-    DEBUG(clkDivider.mCurPhase, DEC);
+  void debug()
+  {
+    DEBUG(">>>RANDOM MODE");
 
-    DEBUG(", clkDiv.edges=");
-    DEBUG(clkDivider.mNumEdges, DEC);
+    DEBUG(", probability=");
+    DEBUG(probability, DEC);
+
+    DEBUG(", loop=");
+    DEBUG(length, DEC);
 
     DEBUG('\n');
   }
@@ -682,78 +1207,233 @@ public:
  * =============================================================================
  */
 
-#define REPORT_RATE 500000
+// Loops between debug reports
+#define REPORT_LOOPS 1000
+
+enum Mode {
+  MODE_DIVIDE,
+  MODE_MULTIPLY,
+  MODE_BURST,
+  MODE_CLOCK,
+  MODE_SWING,
+  MODE_DELAY,
+  MODE_LENGTHEN,
+  MODE_EUCLIDEAN,
+  MODE_RANDOM,
+  NUM_MODES,
+};
+
+JNTUB::DiscreteKnob<NUM_MODES, HYSTERESIS_AMT> modeKnob;
+
+// State of the mode the timer interrupt is running. Only one at a time; all
+// of them at once wouldn't fit in the ATtiny85's SRAM.
+union Modes {
+  ClockMode clock;
+  BurstMode burst;
+  MultiplyMode multiply;
+  GateMode gate;
+  EuclideanMode euclidean;
+  RandomMode random;
+
+  // Members are built by setMode().
+  Modes() {}
+} modes;
 
-const uint8_t NUM_MODES = 4;
+// Mode the timer interrupt is running
+volatile uint8_t mode;
 
-JNTUB::DiscreteKnob modeKnob(NUM_MODES, HYSTERESIS_AMT);
-ClockMode clockMode;
-BurstMode burstMode;
-MultiplyMode multiplyMode;
+// Seeds Random mode. Seeded from the knobs at power-up and advanced every
+// loop, so it depends on exactly when the mode was selected.
+JNTUB::Random entropy;
 
-uint32_t lastReport;
+// Keep ADC noise from flickering the knobs between steps and from having
+// rates recomputed every loop.
+JNTUB::AdaptiveSmoother<1, 5> modeSmoother;
+JNTUB::AdaptiveSmoother<1, 5> rangeRptSmoother;
+JNTUB::AdaptiveSmoother<1, 5> rateSmoother;
+
+uint16_t loopsSinceReport;
+
+// Set by the pin change interrupt when GATE/TRG goes high, so that a trigger
+// that starts and ends between two ticks is still seen.
+volatile bool gateRose;
+
+/**
+ * Switch the timer interrupt over to a mode, starting it from scratch.
+ */
+void setMode(uint8_t newMode)
+{
+  noInterrupts();
+  switch(newMode) {
+    case MODE_DIVIDE:
+    case MODE_MULTIPLY:
+    case MODE_SWING:
+      new (&modes.multiply) MultiplyMode();
+      modes.multiply.reset();
+      break;
+    case MODE_BURST:
+      new (&modes.burst) BurstMode();
+      modes.burst.reset();
+      break;
+    case MODE_CLOCK:
+      new (&modes.clock) ClockMode();
+      modes.clock.reset();
+      break;
+    case MODE_DELAY:
+    case MODE_LENGTHEN:
+      new (&modes.gate) GateMode();
+      modes.gate.reset();
+      break;
+    case MODE_EUCLIDEAN:
+      new (&modes.euclidean) EuclideanMode();
+      modes.euclidean.reset();
+      break;
+    case MODE_RANDOM:
+      new (&modes.random) RandomMode(entropy.next());
+      modes.random.reset();
+      break;
+    default:
+      break;
+  }
+  mode = newMode;
+  interrupts();
+}
 
 void setup()
 {
   DEBUGINIT();
 
-  clockMode.setup();
-  burstMode.setup();
-  multiplyMode.setup();
+  uint16_t modeIn = analogRead(JNTUB::PIN_PARAM3);
+  uint16_t rangeRptIn = analogRead(JNTUB::PIN_PARAM2);
+  uint16_t rateIn = analogRead(JNTUB::PIN_PARAM1);
+  modeSmoother.reset(modeIn);
+  rangeRptSmoother.reset(rangeRptIn);
+  rateSmoother.reset(rateIn);
+  entropy.seed(rateIn ^ (rangeRptIn << 3) ^ (modeIn << 6));
+
+  modeKnob.update(modeSmoother.getValue());
+  setMode(modeKnob.getValue());
+
+  loopsSinceReport = 0;
+  gateRose = false;
 
-  lastReport = 0;
+  JNTUB::setUpTimerInterrupt(TIMER_RATE);
+  JNTUB::setUpGateInterrupt();
 }
 
 void loop()
 {
-  uint16_t modeIn = analogRead(JNTUB::PIN_PARAM3);
-  uint16_t rangeRptIn = analogRead(JNTUB::PIN_PARAM2);
-  uint16_t rateIn = analogRead(JNTUB::PIN_PARAM1);
-  bool gateIn = digitalRead(JNTUB::PIN_GATE_TRG);
-  uint32_t tMillis = millis();
-  uint32_t tMicros = micros();
+  entropy.next();
+
+  uint16_t modeIn = modeSmoother.update(analogRead(JNTUB::PIN_PARAM3));
+  uint16_t rangeRptIn = rangeRptSmoother.update(analogRead(JNTUB::PIN_PARAM2));
+  uint16_t rateIn = rateSmoother.update(analogRead(JNTUB::PIN_PARAM1));
 
   modeKnob.update(modeIn);
-  uint8_t mode = modeKnob.getValue();
+  if (modeKnob.valueChanged())
+    setMode(modeKnob.getValue());
 
-  bool output = 0;
   switch(mode) {
-    case 0:
-      output = multiplyMode.loop(
-          tMicros, rateIn, rangeRptIn, gateIn, true /* divide */);
+    case MODE_DIVIDE:
+      modes.multiply.update(rateIn, rangeRptIn, true /* divide */);
+      break;
+    case MODE_MULTIPLY:
+      modes.multiply.update(rateIn, rangeRptIn, false /* multiply */);
+      break;
+    case MODE_SWING:
+      modes.multiply.updateSwing(rateIn, rangeRptIn);
+      break;
+    case MODE_BURST:
+      modes.burst.update(rateIn, rangeRptIn);
       break;
-    case 1:
-      output = multiplyMode.loop(
-          tMicros, rateIn, rangeRptIn, gateIn, false /* multiply */);
+    case MODE_CLOCK:
+      modes.clock.update(rateIn, rangeRptIn);
       break;
-    case 2:
-      output = burstMode.loop(tMillis, rateIn, rangeRptIn, gateIn);
+    case MODE_DELAY:
+    case MODE_LENGTHEN:
+      modes.gate.update(rateIn);
       break;
-    case 3:
-      output = clockMode.loop(tMillis, rateIn, rangeRptIn, gateIn);
+    case MODE_EUCLIDEAN:
+      modes.euclidean.update(rateIn, rangeRptIn);
+      break;
+    case MODE_RANDOM:
+      modes.random.update(rateIn, rangeRptIn);
       break;
     default:
       break;
   };
 
-  if (tMicros - lastReport >= REPORT_RATE) {
-    lastReport = tMicros;
+  if (++loopsSinceReport >= REPORT_LOOPS) {
+    loopsSinceReport = 0;
     DEBUG(mode, DEC);
     switch(mode) {
-      case 0:
-      case 1:
-        multiplyMode.debug();
+      case MODE_DIVIDE:
+      case MODE_MULTIPLY:
+      case MODE_SWING:
+        modes.multiply.debug();
+        break;
+      case MODE_BURST:
+        modes.burst.debug();
+        break;
+      case MODE_CLOCK:
+        modes.clock.debug();
+        break;
+      case MODE_DELAY:
+      case MODE_LENGTHEN:
+        modes.gate.debug();
         break;
-      case 2:
-        burstMode.debug();
+      case MODE_EUCLIDEAN:
+        modes.euclidean.debug();
         break;
-      case 3:
-        clockMode.debug();
+      case MODE_RANDOM:
+        modes.random.debug();
         break;
       default:
         break;
     }
   }
+}
+
+ISR(GATE_INTERRUPT)
+{
+  if (digitalRead(JNTUB::PIN_GATE_TRG))
+    gateRose = true;
+}
+
+ISR(TIMER_INTERRUPT)
+{
+  // A trigger shorter than a tick reads as high for one tick.
+  bool gateIn = digitalRead(JNTUB::PIN_GATE_TRG) || gateRose;
+  gateRose = false;
+
+  bool output = 0;
+  switch(mode) {
+    case MODE_DIVIDE:
+    case MODE_MULTIPLY:
+    case MODE_SWING:
+      output = modes.multiply.tick(gateIn);
+      break;
+    case MODE_BURST:
+      output = modes.burst.tick(gateIn);
+      break;
+    case MODE_CLOCK:
+      output = modes.clock.tick(gateIn);
+      break;
+    case MODE_DELAY:
+      output = modes.gate.tickDelay(gateIn);
+      break;
+    case MODE_LENGTHEN:
+      output = modes.gate.tickLengthen(gateIn);
+      break;
+    case MODE_EUCLIDEAN:
+      output = modes.euclidean.tick(gateIn);
+      break;
+    case MODE_RANDOM:
+      output = modes.random.tick(gateIn);
+      break;
+    default:
+      break;
+  };
 
   JNTUB::digitalWriteOut(output);
 }
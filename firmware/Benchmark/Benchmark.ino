@@ -0,0 +1,212 @@
+/*
+  Copyright (C) 2021  Ben Reeves
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+  ==============================================================================
+
+  Project:     JNTUB Library Benchmarks
+  File:        Benchmark.ino
+
+  Times pieces of the JNTUB library in CPU cycles and prints the results over
+  serial. Meant to be run on an Arduino Uno (or anything else with an AVR core
+  and a 16-bit Timer1), since the ATTiny85 has no serial port. The ATTiny85
+  has no hardware multiplier, so anything that multiplies will be slower there.
+
+  Each result is the average number of cycles per call, with the cost of the
+  timing itself already subtracted. Interrupts are disabled while timing.
+
+  Code under test is wrapped in noinline functions whose names start with
+  "bench", so their code sizes can be compared with:
+
+    avr-nm --size-sort -C -S Benchmark.ino.elf | grep bench
+ */
+
+// JoyfulNoise Tiny Utility Board Library
+#include <JNTUB.h>
+
+#define ITERATIONS 1000
+
+// Keeps the compiler from optimizing away results we never use.
+volatile int16_t sink;
+volatile uint16_t input;
+
+/**
+ * Run STATEMENT ITERATIONS times, timing each run with Timer1 running at the
+ * CPU clock, and store the average number of cycles per run in RESULT.
+ */
+#define BENCHMARK(RESULT, STATEMENT) \
+  do { \
+    uint32_t total = 0; \
+    noInterrupts(); \
+    for (uint16_t iter = 0; iter < ITERATIONS; ++iter) { \
+      uint16_t start = TCNT1; \
+      STATEMENT; \
+      total += (uint16_t)(TCNT1 - start); \
+    } \
+    interrupts(); \
+    RESULT = total / ITERATIONS; \
+  } while (0)
+
+uint32_t overhead;
+
+void report(const char *name, uint32_t cycles)
+{
+  Serial.print(name);
+  Serial.print(": ");
+  Serial.println(cycles - overhead);
+}
+
+/******************************************************************************
+ * Delay lines
+ ******************************************************************************/
+
+JNTUB::RingBuffer<int8_t, 350> ringBuffer;
+JNTUB::PackedDelayLine<640, 32> packedDelayLine;
+
+// One Karplus-Strong sample: read three neighbouring samples, write one.
+template<typename DelayLine>
+inline void delayLineStep(DelayLine &line, uint16_t period)
+{
+  int16_t sum = line[period + 1] + line[period] + line[period - 1];
+  line.push(sum >> 2);
+  sink = sum;
+}
+
+__attribute__((noinline)) void benchRingBufferStep()
+{
+  delayLineStep(ringBuffer, input);
+}
+
+__attribute__((noinline)) void benchPackedDelayLineStep()
+{
+  delayLineStep(packedDelayLine, input);
+}
+
+void benchmarkDelayLines()
+{
+  uint32_t cycles;
+
+  BENCHMARK(cycles, benchRingBufferStep());
+  report("RingBuffer<int8_t, 350> step", cycles);
+
+  BENCHMARK(cycles, benchPackedDelayLineStep());
+  report("PackedDelayLine<640, 32> step", cycles);
+}
+
+/******************************************************************************
+ * FastClock
+ ******************************************************************************/
+
+/**
+ * FastClock as it was before its phase was widened to 32 bits: 30-bit phase,
+ * running check, previous state saved and wrap compared every tick.
+ */
+class LegacyFastClock {
+public:
+  static const uint32_t PHASE_MAX = (uint32_t)1 << 30;
+
+  uint32_t mCurPhase;
+  volatile uint32_t mRate;
+  volatile uint32_t mDuty;
+  volatile uint32_t mCycles;
+  bool mRunning: 1;
+  bool mPrevState: 1;
+
+  LegacyFastClock()
+  {
+    mCurPhase = 0;
+    mRate = 0;
+    mDuty = PHASE_MAX / 2;
+    mCycles = 0;
+    mRunning = true;
+    mPrevState = false;
+  }
+
+  bool getState() const
+  {
+    return mCurPhase < mDuty;
+  }
+
+  bool isRising() const
+  {
+    return getState() & !mPrevState;
+  }
+
+  void tick()
+  {
+    if (mRunning) {
+      mPrevState = getState();
+      mCurPhase += mRate;
+      if (mCurPhase >= PHASE_MAX) {
+        mCurPhase -= PHASE_MAX;
+        ++mCycles;
+      }
+    }
+  }
+};
+
+LegacyFastClock legacyClock;
+JNTUB::FastClock fastClock(JNTUB::SAMPLE_RATE_10_KHZ);
+
+__attribute__((noinline)) void benchLegacyFastClockTick()
+{
+  legacyClock.tick();
+  sink = legacyClock.isRising();
+}
+
+__attribute__((noinline)) void benchFastClockTick()
+{
+  fastClock.tick();
+  sink = fastClock.isRising();
+}
+
+void benchmarkFastClocks()
+{
+  uint32_t cycles;
+
+  // Fast enough that both wrap now and then.
+  legacyClock.mRate = LegacyFastClock::PHASE_MAX / 100;
+  fastClock.setRate(UINT32_MAX / 100);
+  fastClock.start();
+
+  BENCHMARK(cycles, benchLegacyFastClockTick());
+  report("Legacy FastClock tick + isRising", cycles);
+
+  BENCHMARK(cycles, benchFastClockTick());
+  report("FastClock tick + isRising", cycles);
+}
+
+void setup()
+{
+  // Timer1: normal mode, no prescaling.
+  TCCR1A = 0;
+  TCCR1B = 1 << CS10;
+
+  Serial.begin(9600);
+
+  input = 300;
+
+  BENCHMARK(overhead, (void)0);
+
+  Serial.print("Timing overhead: ");
+  Serial.println(overhead);
+
+  benchmarkDelayLines();
+  benchmarkFastClocks();
+}
+
+void loop()
+{
+}
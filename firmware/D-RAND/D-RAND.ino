@@ -57,16 +57,19 @@
 
 JNTUB::EdgeDetector trigger;
 
-const uint16_t SLEW_RATE_CURVE[] = {
+const uint16_t SLEW_RATE_CURVE[] PROGMEM = {
   0,  // no slew
   150,  // 150ms slew
   1000,  // 1s slew
 };
-JNTUB::CurveKnob<uint16_t> slewRateKnob(SLEW_RATE_CURVE, NELEM(SLEW_RATE_CURVE));
+JNTUB::CurveKnob<uint16_t, JNTUB::ProgmemStorage> slewRateKnob(
+  SLEW_RATE_CURVE, NELEM(SLEW_RATE_CURVE));
 
 // Used to time the slew
 JNTUB::Stopwatch stopwatch;
 
+JNTUB::Random rng;
+
 uint8_t prevVal;
 uint8_t targetVal;
 
@@ -95,7 +98,8 @@ void loop()
 
   if (trigger.isRising()) {
     prevVal = targetVal;
-    targetVal = random(low, high);
+    // Random value in [low, high) without the cost of random(low, high).
+    targetVal = JNTUB::lerp<8>(low, high, rng.nextByte());
     stopwatch.reset();
   }
 
@@ -25,89 +25,26 @@
 // JoyfulNoise Tiny Utility Board Library
 #include <JNTUB.h>
 
+#define SAMPLE_RATE JNTUB::SAMPLE_RATE_20_KHZ
+
 // Wavetables and note data
 #include "Tables.h"
 
-#define isneg(a) (a < 0)
-#define neg(a) (~a + 1)
-
 /**
- * Blends between two values with no divides.
+ * Blends between two values with no divides or multiplies.
  * For blend=0, returns a
  * For blend=64, returns average of a and b
  * For blend=128, returns b
  *
- * XXX: Turns out this is too slow! Curse you, multiplication!!
- * Attempt 1 to fix: make fastBlend where I do a manual less-than-8-bit
- * multiplication by hand with shifts and adds.
- * If that doesn't work, I will store the blended wavetable in memory
- * compute the whole thing during loop().
+ * This used to be too slow to run per sample (the ATtiny has no hardware
+ * multiplier), which is why the blended wavetable is computed in loop().
+ * JNTUB::lerp() does the multiply by the blend factor with shifts and adds.
  */
 int8_t blend(int8_t a, int8_t b, uint8_t blend)
 {
   if (blend > 128)
     blend = 128;
-  // Guaranteed to not overflow. INT8_MAX * 64 + INT8_MAX * 64 == 2^14 - 1
-  int16_t aScaled = a * (128-blend);
-  int16_t bScaled = b * blend;
-  return (aScaled + bScaled) >> 7;
-  //return (blend > 64) ? b : a;
-}
-
-/**
- * Quickly multiply an unsigned byte by some small value no greater than max.
- */
-uint16_t fastMultiplyUnsigned(uint8_t op, uint8_t multiplicand, uint8_t max)
-{
-  // result = op * 2^0 * (multiplicand & 2^0) +
-  //          op * 2^1 * (multiplicand & 2^1) +
-  //          etc...
-  uint8_t N = 1;
-  int16_t opTimesN = op;
-  int16_t result = 0;
-
-  while (N <= max) {
-    result += (multiplicand & N) ? opTimesN : 0;
-    N = N << 1;
-    opTimesN = opTimesN << 1;
-  }
-
-  return result;
-}
-
-/**
- * Quickly multiply a signed byte by some small signed value no greater
- * than +max and no less than -max.
- */
-int16_t fastMultiplySigned(int8_t op, int8_t multiplicand, int8_t max)
-{
-  bool negateResult = 0;
-  if (isneg(op)) {
-    op = neg(op);
-    negateResult ^= 1;
-  }
-  if (isneg(multiplicand)) {
-    multiplicand = neg(multiplicand);
-    negateResult ^= 1;
-  }
-  uint16_t result = fastMultiplyUnsigned(op, multiplicand, max);
-  return negateResult ? neg(result) : result;
-}
-
-/**
- * Blends between two values with no divides or multiplies.
- * For blend=0, returns a
- * For blend=16, returns average of a and b
- * For blend=32, returns b
- */
-int8_t fastBlend(int8_t a, int8_t b, uint8_t blend)
-{
-  if (blend > 32)
-    blend = 32;
-
-  int16_t aScaled = fastMultiplySigned(a, 32 - blend, 32);
-  int16_t bScaled = fastMultiplySigned(b, blend, 32);
-  return (aScaled + bScaled) >> 5;
+  return JNTUB::lerp<7>(a, b, blend);
 }
 
 
@@ -120,28 +57,24 @@ private:
   // Some indexable wavetable.
   const WavetableT *mWavetable;
 
-  // Phase accumulator.
-  uint16_t mPhase;
-
-  // Pitch of the oscillator expressed as fraction of periods per sample.
-  uint16_t mPitch;
+  // Phase accumulator. Its increment is the pitch of the oscillator,
+  // expressed as fraction of periods per sample.
+  JNTUB::PhaseAccumulator<16> mPhase;
 
 public:
   Oscillator()
   {
-    mPhase = 0;
-    mPitch = 0;
     mWavetable = nullptr;
   }
 
   inline void setPitch(uint16_t pitch)
   {
-    mPitch = pitch;
+    mPhase.setIncrement(pitch);
   }
 
   inline void setPhase(uint16_t phase)
   {
-    mPhase = phase;
+    mPhase.setPhase(phase);
   }
 
   inline void setWavetable(const WavetableT *wavetable)
@@ -151,9 +84,9 @@ public:
 
   inline int8_t getSample()
   {
-    mPhase += mPitch;
+    mPhase.tick();
     if (mWavetable)
-      return mWavetable->getValue(mPhase);
+      return mWavetable->getValue(mPhase.getPhase());
     return 0;
   }
 };
@@ -186,15 +119,35 @@ public:
 
 /**
  * The wavetables to be blended between.
+ * Only the sine is stored; the rest are computed from the phase.
  */
-#define NUM_WAVETABLES 4
-const int8_t *const WAVETABLES[NUM_WAVETABLES] = {
-  WT_SINE,
-  WT_TRIANGLE,
-  WT_SAWTOOTH,
-  WT_SQUARE,
+enum WaveShape {
+  WAVE_SINE,
+  WAVE_TRIANGLE,
+  WAVE_SAWTOOTH,
+  WAVE_SQUARE,
+  NUM_WAVETABLES,
 };
 
+const SineTable SINE(WT_SINE_QUARTER);
+
+/**
+ * Sample of the given wave shape at an 8-bit phase.
+ */
+int8_t waveSample(uint8_t shape, uint8_t phase)
+{
+  switch (shape) {
+    case WAVE_SINE:
+      return SINE.read(phase);
+    case WAVE_TRIANGLE:
+      return JNTUB::triangleWave<8>(phase);
+    case WAVE_SAWTOOTH:
+      return JNTUB::sawWave<8>(phase);
+    default:
+      return JNTUB::squareWave<8>(phase);
+  }
+}
+
 /**
  * The multiplications required to compute the blended wave shape
  * are too expensive to perform during each sample.
@@ -218,14 +171,14 @@ uint8_t onDeckWavetable;
  * array result.
  */
 void blendWavetables(
-  const int8_t *tableA,
-  const int8_t *tableB,
+  uint8_t shapeA,
+  uint8_t shapeB,
   uint8_t blendAmt,
   int8_t *result)
 {
   for (uint8_t i = 0; i < 128; ++i) {
-    int8_t sampA = pgm_read_byte_near(tableA + i*2);
-    int8_t sampB = pgm_read_byte_near(tableB + i*2);
+    int8_t sampA = waveSample(shapeA, i*2);
+    int8_t sampB = waveSample(shapeB, i*2);
     result[i] = blend(sampA, sampB, blendAmt);
   }
 }
@@ -238,34 +191,52 @@ void blendWavetables(
 Oscillator<SRAMWavetable<7>> oscs[NUM_OSCS];
 
 // Map input range to midi notes 0 to 119 (10 octaves)
-JNTUB::DiscreteKnob pitchKnob(120, 1);
+JNTUB::DiscreteKnob<120, 1> pitchKnob;
 
-JNTUB::DiscreteKnob waveKnob(NUM_WAVETABLES-1, 1);
+uint16_t notePitch(uint8_t midiNote)
+{
+  return pgm_read_word(&MIDI_NOTE_PITCHES[midiNote]);
+}
+
+// Only look the pitch up again when the note changes.
+JNTUB::Param<uint8_t, uint16_t> pitchParam(notePitch);
+
+JNTUB::DiscreteKnob<NUM_WAVETABLES-1, 1> waveKnob;
 uint8_t currentTable;
 uint8_t currentBlend;
 
 #define DETUNE_MIN 0
 #define DETUNE_MAX 10
 #define MAX_SUB_OCTAVE 2
-JNTUB::DiscreteKnob detuneKnob(MAX_SUB_OCTAVE + 1, 1);
+JNTUB::DiscreteKnob<MAX_SUB_OCTAVE + 1, 1> detuneKnob;
 
 JNTUB::EdgeDetector sync;
 
+// ADC noise would otherwise make the pitch warble, and have the blended
+// wavetable rebuilt every time the WAVE knob flickers by a step.
+JNTUB::AdaptiveSmoother<1, 5> pitchSmoother;
+JNTUB::AdaptiveSmoother<1, 5> waveSmoother;
+JNTUB::AdaptiveSmoother<1, 5> detuneSmoother;
+
 void setup()
 {
   onDeckWavetable = 1;
   currentTable = 0;
   currentBlend = 0;
 
+  pitchSmoother.reset(analogRead(JNTUB::PIN_PARAM1));
+  waveSmoother.reset(analogRead(JNTUB::PIN_PARAM2));
+  detuneSmoother.reset(analogRead(JNTUB::PIN_PARAM3));
+
   JNTUB::setUpFastPWM();
-  JNTUB::setUpTimerInterrupt(JNTUB::SAMPLE_RATE_20_KHZ);
+  JNTUB::setUpTimerInterrupt(SAMPLE_RATE);
 }
 
 void loop()
 {
-  uint16_t pitchRaw = analogRead(JNTUB::PIN_PARAM1);
-  uint16_t waveRaw = analogRead(JNTUB::PIN_PARAM2);
-  uint16_t detuneRaw = analogRead(JNTUB::PIN_PARAM3);
+  uint16_t pitchRaw = pitchSmoother.update(analogRead(JNTUB::PIN_PARAM1));
+  uint16_t waveRaw = waveSmoother.update(analogRead(JNTUB::PIN_PARAM2));
+  uint16_t detuneRaw = detuneSmoother.update(analogRead(JNTUB::PIN_PARAM3));
   bool syncRaw = digitalRead(JNTUB::PIN_GATE_TRG);
 
   pitchKnob.update(pitchRaw);
@@ -273,8 +244,8 @@ void loop()
   detuneKnob.update(detuneRaw);
   sync.update(syncRaw);
 
-  uint8_t midiNote = pitchKnob.getValue();
-  uint16_t pitch = pgm_read_word(&MIDI_NOTE_PITCHES[midiNote]);
+  pitchParam.update(pitchKnob.getValue());
+  uint16_t pitch = pitchParam.getValue();
   uint8_t subOct = detuneKnob.getValue();
   uint16_t detune = detuneKnob.mapInnerValue(DETUNE_MIN, DETUNE_MAX);
   oscs[0].setPitch(pitch >> subOct);
@@ -294,8 +265,8 @@ void loop()
   if (tableSelect != currentTable || blend != currentBlend) {
     // Compute new blended wavetable
     blendWavetables(
-      WAVETABLES[tableSelect],
-      WAVETABLES[tableSelect+1],
+      tableSelect,
+      tableSelect+1,
       blend,
       BLENDED_WAVETABLES[onDeckWavetable].getPtr());
 
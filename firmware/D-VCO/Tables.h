@@ -22,1569 +22,29 @@
 
  */
 
-#include <avr/pgmspace.h>
-#include <stdint.h>
+// JoyfulNoise Tiny Utility Board Library
+#include <JNTUB.h>
 
 /**
- * Sample rate is 20 kHz, and phase increments from 0 to 65535 in increments
- * of Pitch units every sample. This gives us the relation:
+ * Phase accumulators are 16 bits and wrap at 65536, and advance by Pitch
+ * every sample. This gives us the relation:
  *
- *   Frequency = (20,000 * Pitch) / 65535
+ *   Frequency = (SampleRate * Pitch) / 65536
  *                   or
- *       Pitch = Frequency * 65535 / 20,000
+ *       Pitch = Frequency * 65536 / SampleRate
  *
- * This table defines this function for MIDI notes 0 to 127.
+ * This table defines this function for MIDI notes 0 to 127, computed at
+ * compile time for SAMPLE_RATE (and the exact rate F_CPU gives for it).
  */
-const uint16_t MIDI_NOTE_PITCHES[128] PROGMEM = {
-  // MIDI 0 - (ideal: 8.18 Hz) (actual: 7.93) (error: 52 cents)
-  26,
-  // MIDI 1 - (ideal: 8.66 Hz) (actual: 8.54) (error: 23 cents)
-  28,
-  // MIDI 2 - (ideal: 9.18 Hz) (actual: 9.16) (error: 4 cents)
-  30,
-  // MIDI 3 - (ideal: 9.72 Hz) (actual: 9.46) (error: 46 cents)
-  31,
-  // MIDI 4 - (ideal: 10.30 Hz) (actual: 10.07) (error: 38 cents)
-  33,
-  // MIDI 5 - (ideal: 10.91 Hz) (actual: 10.68) (error: 36 cents)
-  35,
-  // MIDI 6 - (ideal: 11.56 Hz) (actual: 11.29) (error: 40 cents)
-  37,
-  // MIDI 7 - (ideal: 12.25 Hz) (actual: 12.21) (error: 6 cents)
-  40,
-  // MIDI 8 - (ideal: 12.98 Hz) (actual: 12.82) (error: 21 cents)
-  42,
-  // MIDI 9 - (ideal: 13.75 Hz) (actual: 13.73) (error: 2 cents)
-  45,
-  // MIDI 10 - (ideal: 14.57 Hz) (actual: 14.34) (error: 27 cents)
-  47,
-  // MIDI 11 - (ideal: 15.43 Hz) (actual: 15.26) (error: 19 cents)
-  50,
-  // MIDI 12 - (ideal: 16.35 Hz) (actual: 16.17) (error: 18 cents)
-  53,
-  // MIDI 13 - (ideal: 17.32 Hz) (actual: 17.09) (error: 23 cents)
-  56,
-  // MIDI 14 - (ideal: 18.35 Hz) (actual: 18.31) (error: 3 cents)
-  60,
-  // MIDI 15 - (ideal: 19.45 Hz) (actual: 19.23) (error: 20 cents)
-  63,
-  // MIDI 16 - (ideal: 20.60 Hz) (actual: 20.45) (error: 12 cents)
-  67,
-  // MIDI 17 - (ideal: 21.83 Hz) (actual: 21.67) (error: 12 cents)
-  71,
-  // MIDI 18 - (ideal: 23.12 Hz) (actual: 22.89) (error: 17 cents)
-  75,
-  // MIDI 19 - (ideal: 24.50 Hz) (actual: 24.41) (error: 6 cents)
-  80,
-  // MIDI 20 - (ideal: 25.96 Hz) (actual: 25.94) (error: 1 cents)
-  85,
-  // MIDI 21 - A0  (ideal: 27.50 Hz) (actual: 27.47) (error: 2 cents)
-  90,
-  // MIDI 22 - A#0 (ideal: 29.14 Hz) (actual: 28.99) (error: 8 cents)
-  95,
-  // MIDI 23 - B0  (ideal: 30.87 Hz) (actual: 30.82) (error: 2 cents)
-  101,
-  // MIDI 24 - C1  (ideal: 32.70 Hz) (actual: 32.65) (error: 2 cents)
-  107,
-  // MIDI 25 - C#1 (ideal: 34.65 Hz) (actual: 34.48) (error: 8 cents)
-  113,
-  // MIDI 26 - D1  (ideal: 36.71 Hz) (actual: 36.62) (error: 4 cents)
-  120,
-  // MIDI 27 - D#1 (ideal: 38.89 Hz) (actual: 38.76) (error: 5 cents)
-  127,
-  // MIDI 28 - E1  (ideal: 41.20 Hz) (actual: 41.20) (error: 0 cents)
-  135,
-  // MIDI 29 - F1  (ideal: 43.65 Hz) (actual: 43.64) (error: 0 cents)
-  143,
-  // MIDI 30 - F#1 (ideal: 46.25 Hz) (actual: 46.08) (error: 6 cents)
-  151,
-  // MIDI 31 - G1  (ideal: 49.00 Hz) (actual: 48.83) (error: 6 cents)
-  160,
-  // MIDI 32 - G#1 (ideal: 51.91 Hz) (actual: 51.88) (error: 1 cents)
-  170,
-  // MIDI 33 - A1  (ideal: 55.00 Hz) (actual: 54.93) (error: 2 cents)
-  180,
-  // MIDI 34 - A#1 (ideal: 58.27 Hz) (actual: 57.98) (error: 8 cents)
-  190,
-  // MIDI 35 - B1  (ideal: 61.74 Hz) (actual: 61.65) (error: 2 cents)
-  202,
-  // MIDI 36 - C2  (ideal: 65.41 Hz) (actual: 65.31) (error: 2 cents)
-  214,
-  // MIDI 37 - C#2 (ideal: 69.30 Hz) (actual: 69.27) (error: 0 cents)
-  227,
-  // MIDI 38 - D2  (ideal: 73.42 Hz) (actual: 73.24) (error: 4 cents)
-  240,
-  // MIDI 39 - D#2 (ideal: 77.78 Hz) (actual: 77.51) (error: 5 cents)
-  254,
-  // MIDI 40 - E2  (ideal: 82.41 Hz) (actual: 82.40) (error: 0 cents)
-  270,
-  // MIDI 41 - F2  (ideal: 87.31 Hz) (actual: 87.28) (error: 0 cents)
-  286,
-  // MIDI 42 - F#2 (ideal: 92.50 Hz) (actual: 92.47) (error: 0 cents)
-  303,
-  // MIDI 43 - G2  (ideal: 98.00 Hz) (actual: 97.96) (error: 0 cents)
-  321,
-  // MIDI 44 - G#2 (ideal: 103.83 Hz) (actual: 103.76) (error: 1 cents)
-  340,
-  // MIDI 45 - A2  (ideal: 110.00 Hz) (actual: 109.86) (error: 2 cents)
-  360,
-  // MIDI 46 - A#2 (ideal: 116.54 Hz) (actual: 116.27) (error: 3 cents)
-  381,
-  // MIDI 47 - B2  (ideal: 123.47 Hz) (actual: 123.29) (error: 2 cents)
-  404,
-  // MIDI 48 - C3  (ideal: 130.81 Hz) (actual: 130.62) (error: 2 cents)
-  428,
-  // MIDI 49 - C#3 (ideal: 138.59 Hz) (actual: 138.55) (error: 0 cents)
-  454,
-  // MIDI 50 - D3  (ideal: 146.83 Hz) (actual: 146.79) (error: 0 cents)
-  481,
-  // MIDI 51 - D#3 (ideal: 155.56 Hz) (actual: 155.33) (error: 2 cents)
-  509,
-  // MIDI 52 - E3  (ideal: 164.81 Hz) (actual: 164.79) (error: 0 cents)
-  540,
-  // MIDI 53 - F3  (ideal: 174.61 Hz) (actual: 174.56) (error: 0 cents)
-  572,
-  // MIDI 54 - F#3 (ideal: 185.00 Hz) (actual: 184.94) (error: 0 cents)
-  606,
-  // MIDI 55 - G3  (ideal: 196.00 Hz) (actual: 195.92) (error: 0 cents)
-  642,
-  // MIDI 56 - G#3 (ideal: 207.65 Hz) (actual: 207.52) (error: 1 cents)
-  680,
-  // MIDI 57 - A3  (ideal: 220.00 Hz) (actual: 219.73) (error: 2 cents)
-  720,
-  // MIDI 58 - A#3 (ideal: 233.08 Hz) (actual: 232.85) (error: 1 cents)
-  763,
-  // MIDI 59 - B3  (ideal: 246.94 Hz) (actual: 246.89) (error: 0 cents)
-  809,
-  // MIDI 60 - C4 (middle C) (ideal: 261.63 Hz) (actual: 261.54) (error: 0 cents)
-  857,
-  // MIDI 61 - C#4 (ideal: 277.18 Hz) (actual: 277.10) (error: 0 cents)
-  908,
-  // MIDI 62 - D4  (ideal: 293.66 Hz) (actual: 293.58) (error: 0 cents)
-  962,
-  // MIDI 63 - D#4 (ideal: 311.13 Hz) (actual: 310.97) (error: 0 cents)
-  1019,
-  // MIDI 64 - E4  (ideal: 329.63 Hz) (actual: 329.59) (error: 0 cents)
-  1080,
-  // MIDI 65 - F4  (ideal: 349.23 Hz) (actual: 349.12) (error: 0 cents)
-  1144,
-  // MIDI 66 - F#4 (ideal: 369.99 Hz) (actual: 369.87) (error: 0 cents)
-  1212,
-  // MIDI 67 - G4  (ideal: 392.00 Hz) (actual: 391.85) (error: 0 cents)
-  1284,
-  // MIDI 68 - G#4 (ideal: 415.30 Hz) (actual: 415.04) (error: 1 cents)
-  1360,
-  // MIDI 69 - A4 (concert pitch) (ideal: 440.00 Hz) (actual: 439.76) (error: 0 cents)
-  1441,
-  // MIDI 70 - A#4 (ideal: 466.16 Hz) (actual: 466.00) (error: 0 cents)
-  1527,
-  // MIDI 71 - B4  (ideal: 493.88 Hz) (actual: 493.77) (error: 0 cents)
-  1618,
-  // MIDI 72 - C5  (ideal: 523.25 Hz) (actual: 523.07) (error: 0 cents)
-  1714,
-  // MIDI 73 - C#5 (ideal: 554.37 Hz) (actual: 554.20) (error: 0 cents)
-  1816,
-  // MIDI 74 - D5  (ideal: 587.33 Hz) (actual: 587.16) (error: 0 cents)
-  1924,
-  // MIDI 75 - D#5 (ideal: 622.25 Hz) (actual: 621.95) (error: 0 cents)
-  2038,
-  // MIDI 76 - E5  (ideal: 659.26 Hz) (actual: 659.18) (error: 0 cents)
-  2160,
-  // MIDI 77 - F5  (ideal: 698.46 Hz) (actual: 698.24) (error: 0 cents)
-  2288,
-  // MIDI 78 - F#5 (ideal: 739.99 Hz) (actual: 739.75) (error: 0 cents)
-  2424,
-  // MIDI 79 - G5  (ideal: 783.99 Hz) (actual: 783.69) (error: 0 cents)
-  2568,
-  // MIDI 80 - G#5 (ideal: 830.61 Hz) (actual: 830.38) (error: 0 cents)
-  2721,
-  // MIDI 81 - A5  (ideal: 880.00 Hz) (actual: 879.82) (error: 0 cents)
-  2883,
-  // MIDI 82 - A#5 (ideal: 932.33 Hz) (actual: 932.31) (error: 0 cents)
-  3055,
-  // MIDI 83 - B5  (ideal: 987.77 Hz) (actual: 987.55) (error: 0 cents)
-  3236,
-  // MIDI 84 - C6  (ideal: 1046.50 Hz) (actual: 1046.45) (error: 0 cents)
-  3429,
-  // MIDI 85 - C#6 (ideal: 1108.73 Hz) (actual: 1108.70) (error: 0 cents)
-  3633,
-  // MIDI 86 - D6  (ideal: 1174.66 Hz) (actual: 1174.62) (error: 0 cents)
-  3849,
-  // MIDI 87 - D#6 (ideal: 1244.51 Hz) (actual: 1244.51) (error: 0 cents)
-  4078,
-  // MIDI 88 - E6  (ideal: 1318.51 Hz) (actual: 1318.36) (error: 0 cents)
-  4320,
-  // MIDI 89 - F6  (ideal: 1396.91 Hz) (actual: 1396.79) (error: 0 cents)
-  4577,
-  // MIDI 90 - F#6 (ideal: 1479.98 Hz) (actual: 1479.80) (error: 0 cents)
-  4849,
-  // MIDI 91 - G6  (ideal: 1567.98 Hz) (actual: 1567.69) (error: 0 cents)
-  5137,
-  // MIDI 92 - G#6 (ideal: 1661.22 Hz) (actual: 1661.07) (error: 0 cents)
-  5443,
-  // MIDI 93 - A6  (ideal: 1760.00 Hz) (actual: 1759.95) (error: 0 cents)
-  5767,
-  // MIDI 94 - A#6 (ideal: 1864.66 Hz) (actual: 1864.62) (error: 0 cents)
-  6110,
-  // MIDI 95 - B6  (ideal: 1975.53 Hz) (actual: 1975.40) (error: 0 cents)
-  6473,
-  // MIDI 96 - C7  (ideal: 2093.00 Hz) (actual: 2092.90) (error: 0 cents)
-  6858,
-  // MIDI 97 - C#7 (ideal: 2217.46 Hz) (actual: 2217.41) (error: 0 cents)
-  7266,
-  // MIDI 98 - D7  (ideal: 2349.32 Hz) (actual: 2349.24) (error: 0 cents)
-  7698,
-  // MIDI 99 - D#7 (ideal: 2489.02 Hz) (actual: 2489.01) (error: 0 cents)
-  8156,
-  // MIDI 100 - E7  (ideal: 2637.02 Hz) (actual: 2636.72) (error: 0 cents)
-  8640,
-  // MIDI 101 - F7  (ideal: 2793.83 Hz) (actual: 2793.58) (error: 0 cents)
-  9154,
-  // MIDI 102 - F#7 (ideal: 2959.96 Hz) (actual: 2959.90) (error: 0 cents)
-  9699,
-  // MIDI 103 - G7  (ideal: 3135.96 Hz) (actual: 3135.68) (error: 0 cents)
-  10275,
-  // MIDI 104 - G#7 (ideal: 3322.44 Hz) (actual: 3322.14) (error: 0 cents)
-  10886,
-  // MIDI 105 - A7  (ideal: 3520.00 Hz) (actual: 3519.90) (error: 0 cents)
-  11534,
-  // MIDI 106 - A#7 (ideal: 3729.31 Hz) (actual: 3729.25) (error: 0 cents)
-  12220,
-  // MIDI 107 - B7  (ideal: 3951.07 Hz) (actual: 3950.81) (error: 0 cents)
-  12946,
-  // MIDI 108 - C8  (ideal: 4186.01 Hz) (actual: 4185.79) (error: 0 cents)
-  13716,
-  // MIDI 109 - C#8 (ideal: 4434.92 Hz) (actual: 4434.81) (error: 0 cents)
-  14532,
-  // MIDI 110 - D8  (ideal: 4698.64 Hz) (actual: 4698.49) (error: 0 cents)
-  15396,
-  // MIDI 111 - D#8 (ideal: 4978.03 Hz) (actual: 4978.03) (error: 0 cents)
-  16312,
-  // MIDI 112 - E8  (ideal: 5274.04 Hz) (actual: 5273.74) (error: 0 cents)
-  17281,
-  // MIDI 113 - F8  (ideal: 5587.65 Hz) (actual: 5587.46) (error: 0 cents)
-  18309,
-  // MIDI 114 - F#8 (ideal: 5919.91 Hz) (actual: 5919.80) (error: 0 cents)
-  19398,
-  // MIDI 115 - G8  (ideal: 6271.93 Hz) (actual: 6271.67) (error: 0 cents)
-  20551,
-  // MIDI 116 - G#8 (ideal: 6644.88 Hz) (actual: 6644.59) (error: 0 cents)
-  21773,
-  // MIDI 117 - A8  (ideal: 7040.00 Hz) (actual: 7039.79) (error: 0 cents)
-  23068,
-  // MIDI 118 - A#8 (ideal: 7458.62 Hz) (actual: 7458.50) (error: 0 cents)
-  24440,
-  // MIDI 119 - B8  (ideal: 7902.13 Hz) (actual: 7901.92) (error: 0 cents)
-  25893,
-  // MIDI 120 - C9  (ideal: 8372.02 Hz) (actual: 8371.89) (error: 0 cents)
-  27433,
-  // MIDI 121 - C#9 (ideal: 8869.84 Hz) (actual: 8869.63) (error: 0 cents)
-  29064,
-  // MIDI 122 - D9  (ideal: 9397.27 Hz) (actual: 9396.97) (error: 0 cents)
-  30792,
-  // MIDI 123 - D#9 (ideal: 9956.06 Hz) (actual: 9956.05) (error: 0 cents)
-  32624,
-  // MIDI 124 - E9  (ideal: 10548.08 Hz) (actual: 10547.79) (error: 0 cents)
-  34563,
-  // MIDI 125 - F9  (ideal: 11175.30 Hz) (actual: 11175.23) (error: 0 cents)
-  36619,
-  // MIDI 126 - F#9 (ideal: 11839.82 Hz) (actual: 11839.60) (error: 0 cents)
-  38796,
-  // MIDI 127 - G9  (ideal: 12543.85 Hz) (actual: 12543.64) (error: 0 cents)
-  41103,
-};
+const uint16_t *const MIDI_NOTE_PITCHES = JNTUB::GeneratedTable<
+  JNTUB::MidiNotePitch<SAMPLE_RATE>, 128>::DATA;
 
-const int8_t WT_SINE[] PROGMEM = {
-  0,  //0
-  3,  //1
-  6,  //2
-  9,  //3
-  12,  //4
-  15,  //5
-  18,  //6
-  21,  //7
-  24,  //8
-  27,  //9
-  30,  //10
-  33,  //11
-  36,  //12
-  39,  //13
-  42,  //14
-  45,  //15
-  48,  //16
-  51,  //17
-  54,  //18
-  57,  //19
-  59,  //20
-  62,  //21
-  65,  //22
-  67,  //23
-  70,  //24
-  73,  //25
-  75,  //26
-  78,  //27
-  80,  //28
-  82,  //29
-  85,  //30
-  87,  //31
-  89,  //32
-  91,  //33
-  94,  //34
-  96,  //35
-  98,  //36
-  100,  //37
-  102,  //38
-  103,  //39
-  105,  //40
-  107,  //41
-  108,  //42
-  110,  //43
-  112,  //44
-  113,  //45
-  114,  //46
-  116,  //47
-  117,  //48
-  118,  //49
-  119,  //50
-  120,  //51
-  121,  //52
-  122,  //53
-  123,  //54
-  123,  //55
-  124,  //56
-  125,  //57
-  125,  //58
-  126,  //59
-  126,  //60
-  126,  //61
-  126,  //62
-  126,  //63
-  127,  //64
-  126,  //65
-  126,  //66
-  126,  //67
-  126,  //68
-  126,  //69
-  125,  //70
-  125,  //71
-  124,  //72
-  123,  //73
-  123,  //74
-  122,  //75
-  121,  //76
-  120,  //77
-  119,  //78
-  118,  //79
-  117,  //80
-  116,  //81
-  114,  //82
-  113,  //83
-  112,  //84
-  110,  //85
-  108,  //86
-  107,  //87
-  105,  //88
-  103,  //89
-  102,  //90
-  100,  //91
-  98,  //92
-  96,  //93
-  94,  //94
-  91,  //95
-  89,  //96
-  87,  //97
-  85,  //98
-  82,  //99
-  80,  //100
-  78,  //101
-  75,  //102
-  73,  //103
-  70,  //104
-  67,  //105
-  65,  //106
-  62,  //107
-  59,  //108
-  57,  //109
-  54,  //110
-  51,  //111
-  48,  //112
-  45,  //113
-  42,  //114
-  39,  //115
-  36,  //116
-  33,  //117
-  30,  //118
-  27,  //119
-  24,  //120
-  21,  //121
-  18,  //122
-  15,  //123
-  12,  //124
-  9,  //125
-  6,  //126
-  3,  //127
-  0,  //128
-  -3,  //129
-  -6,  //130
-  -9,  //131
-  -12,  //132
-  -15,  //133
-  -18,  //134
-  -21,  //135
-  -24,  //136
-  -27,  //137
-  -30,  //138
-  -33,  //139
-  -36,  //140
-  -39,  //141
-  -42,  //142
-  -45,  //143
-  -48,  //144
-  -51,  //145
-  -54,  //146
-  -57,  //147
-  -59,  //148
-  -62,  //149
-  -65,  //150
-  -67,  //151
-  -70,  //152
-  -73,  //153
-  -75,  //154
-  -78,  //155
-  -80,  //156
-  -82,  //157
-  -85,  //158
-  -87,  //159
-  -89,  //160
-  -91,  //161
-  -94,  //162
-  -96,  //163
-  -98,  //164
-  -100,  //165
-  -102,  //166
-  -103,  //167
-  -105,  //168
-  -107,  //169
-  -108,  //170
-  -110,  //171
-  -112,  //172
-  -113,  //173
-  -114,  //174
-  -116,  //175
-  -117,  //176
-  -118,  //177
-  -119,  //178
-  -120,  //179
-  -121,  //180
-  -122,  //181
-  -123,  //182
-  -123,  //183
-  -124,  //184
-  -125,  //185
-  -125,  //186
-  -126,  //187
-  -126,  //188
-  -126,  //189
-  -126,  //190
-  -126,  //191
-  -127,  //192
-  -126,  //193
-  -126,  //194
-  -126,  //195
-  -126,  //196
-  -126,  //197
-  -125,  //198
-  -125,  //199
-  -124,  //200
-  -123,  //201
-  -123,  //202
-  -122,  //203
-  -121,  //204
-  -120,  //205
-  -119,  //206
-  -118,  //207
-  -117,  //208
-  -116,  //209
-  -114,  //210
-  -113,  //211
-  -112,  //212
-  -110,  //213
-  -108,  //214
-  -107,  //215
-  -105,  //216
-  -103,  //217
-  -102,  //218
-  -100,  //219
-  -98,  //220
-  -96,  //221
-  -94,  //222
-  -91,  //223
-  -89,  //224
-  -87,  //225
-  -85,  //226
-  -82,  //227
-  -80,  //228
-  -78,  //229
-  -75,  //230
-  -73,  //231
-  -70,  //232
-  -67,  //233
-  -65,  //234
-  -62,  //235
-  -59,  //236
-  -57,  //237
-  -54,  //238
-  -51,  //239
-  -48,  //240
-  -45,  //241
-  -42,  //242
-  -39,  //243
-  -36,  //244
-  -33,  //245
-  -30,  //246
-  -27,  //247
-  -24,  //248
-  -21,  //249
-  -18,  //250
-  -15,  //251
-  -12,  //252
-  -9,  //253
-  -6,  //254
-  -4,  //255
-};
-
-const int8_t WT_TRIANGLE[] PROGMEM = {
-  0,  //0
-  1,  //1
-  3,  //2
-  5,  //3
-  7,  //4
-  9,  //5
-  11,  //6
-  13,  //7
-  15,  //8
-  17,  //9
-  19,  //10
-  21,  //11
-  23,  //12
-  25,  //13
-  27,  //14
-  29,  //15
-  31,  //16
-  33,  //17
-  35,  //18
-  37,  //19
-  39,  //20
-  41,  //21
-  43,  //22
-  45,  //23
-  47,  //24
-  49,  //25
-  51,  //26
-  53,  //27
-  55,  //28
-  57,  //29
-  59,  //30
-  61,  //31
-  63,  //32
-  65,  //33
-  67,  //34
-  69,  //35
-  71,  //36
-  73,  //37
-  75,  //38
-  77,  //39
-  79,  //40
-  81,  //41
-  83,  //42
-  85,  //43
-  87,  //44
-  89,  //45
-  91,  //46
-  93,  //47
-  95,  //48
-  97,  //49
-  99,  //50
-  101,  //51
-  103,  //52
-  105,  //53
-  107,  //54
-  109,  //55
-  111,  //56
-  113,  //57
-  115,  //58
-  117,  //59
-  119,  //60
-  121,  //61
-  123,  //62
-  125,  //63
-  127,  //64
-  125,  //65
-  123,  //66
-  121,  //67
-  119,  //68
-  117,  //69
-  115,  //70
-  113,  //71
-  111,  //72
-  109,  //73
-  107,  //74
-  105,  //75
-  103,  //76
-  101,  //77
-  99,  //78
-  97,  //79
-  95,  //80
-  93,  //81
-  91,  //82
-  89,  //83
-  87,  //84
-  85,  //85
-  83,  //86
-  81,  //87
-  79,  //88
-  77,  //89
-  75,  //90
-  73,  //91
-  71,  //92
-  69,  //93
-  67,  //94
-  65,  //95
-  63,  //96
-  61,  //97
-  59,  //98
-  57,  //99
-  55,  //100
-  53,  //101
-  51,  //102
-  49,  //103
-  47,  //104
-  45,  //105
-  43,  //106
-  41,  //107
-  39,  //108
-  37,  //109
-  35,  //110
-  33,  //111
-  31,  //112
-  29,  //113
-  27,  //114
-  25,  //115
-  23,  //116
-  21,  //117
-  19,  //118
-  17,  //119
-  15,  //120
-  13,  //121
-  11,  //122
-  9,  //123
-  7,  //124
-  5,  //125
-  3,  //126
-  1,  //127
-  0,  //128
-  -1,  //129
-  -3,  //130
-  -5,  //131
-  -7,  //132
-  -9,  //133
-  -11,  //134
-  -13,  //135
-  -15,  //136
-  -17,  //137
-  -19,  //138
-  -21,  //139
-  -23,  //140
-  -25,  //141
-  -27,  //142
-  -29,  //143
-  -31,  //144
-  -33,  //145
-  -35,  //146
-  -37,  //147
-  -39,  //148
-  -41,  //149
-  -43,  //150
-  -45,  //151
-  -47,  //152
-  -49,  //153
-  -51,  //154
-  -53,  //155
-  -55,  //156
-  -57,  //157
-  -59,  //158
-  -61,  //159
-  -63,  //160
-  -65,  //161
-  -67,  //162
-  -69,  //163
-  -71,  //164
-  -73,  //165
-  -75,  //166
-  -77,  //167
-  -79,  //168
-  -81,  //169
-  -83,  //170
-  -85,  //171
-  -87,  //172
-  -89,  //173
-  -91,  //174
-  -93,  //175
-  -95,  //176
-  -97,  //177
-  -99,  //178
-  -101,  //179
-  -103,  //180
-  -105,  //181
-  -107,  //182
-  -109,  //183
-  -111,  //184
-  -113,  //185
-  -115,  //186
-  -117,  //187
-  -119,  //188
-  -121,  //189
-  -123,  //190
-  -125,  //191
-  -127,  //192
-  -125,  //193
-  -123,  //194
-  -121,  //195
-  -119,  //196
-  -117,  //197
-  -115,  //198
-  -113,  //199
-  -111,  //200
-  -109,  //201
-  -107,  //202
-  -105,  //203
-  -103,  //204
-  -101,  //205
-  -99,  //206
-  -97,  //207
-  -95,  //208
-  -93,  //209
-  -91,  //210
-  -89,  //211
-  -87,  //212
-  -85,  //213
-  -83,  //214
-  -81,  //215
-  -79,  //216
-  -77,  //217
-  -75,  //218
-  -73,  //219
-  -71,  //220
-  -69,  //221
-  -67,  //222
-  -65,  //223
-  -63,  //224
-  -61,  //225
-  -59,  //226
-  -57,  //227
-  -55,  //228
-  -53,  //229
-  -51,  //230
-  -49,  //231
-  -47,  //232
-  -45,  //233
-  -43,  //234
-  -41,  //235
-  -39,  //236
-  -37,  //237
-  -35,  //238
-  -33,  //239
-  -31,  //240
-  -29,  //241
-  -27,  //242
-  -25,  //243
-  -23,  //244
-  -21,  //245
-  -19,  //246
-  -17,  //247
-  -15,  //248
-  -13,  //249
-  -11,  //250
-  -9,  //251
-  -7,  //252
-  -5,  //253
-  -3,  //254
-  -2,  //255
-};
-
-const int8_t WT_SAWTOOTH[] PROGMEM = {
-  128,  //0
-  127,  //1
-  126,  //2
-  125,  //3
-  124,  //4
-  123,  //5
-  122,  //6
-  121,  //7
-  120,  //8
-  119,  //9
-  118,  //10
-  117,  //11
-  116,  //12
-  115,  //13
-  114,  //14
-  113,  //15
-  112,  //16
-  111,  //17
-  110,  //18
-  109,  //19
-  108,  //20
-  107,  //21
-  106,  //22
-  105,  //23
-  104,  //24
-  103,  //25
-  102,  //26
-  101,  //27
-  100,  //28
-  99,  //29
-  98,  //30
-  97,  //31
-  96,  //32
-  95,  //33
-  94,  //34
-  93,  //35
-  92,  //36
-  91,  //37
-  90,  //38
-  89,  //39
-  88,  //40
-  87,  //41
-  86,  //42
-  85,  //43
-  84,  //44
-  83,  //45
-  82,  //46
-  81,  //47
-  80,  //48
-  79,  //49
-  78,  //50
-  77,  //51
-  76,  //52
-  75,  //53
-  74,  //54
-  73,  //55
-  72,  //56
-  71,  //57
-  70,  //58
-  69,  //59
-  68,  //60
-  67,  //61
-  66,  //62
-  65,  //63
-  64,  //64
-  63,  //65
-  62,  //66
-  61,  //67
-  60,  //68
-  59,  //69
-  58,  //70
-  57,  //71
-  56,  //72
-  55,  //73
-  54,  //74
-  53,  //75
-  52,  //76
-  51,  //77
-  50,  //78
-  49,  //79
-  48,  //80
-  47,  //81
-  46,  //82
-  45,  //83
-  44,  //84
-  43,  //85
-  42,  //86
-  41,  //87
-  40,  //88
-  39,  //89
-  38,  //90
-  37,  //91
-  36,  //92
-  35,  //93
-  34,  //94
-  33,  //95
-  32,  //96
-  31,  //97
-  30,  //98
-  29,  //99
-  28,  //100
-  27,  //101
-  26,  //102
-  25,  //103
-  24,  //104
-  23,  //105
-  22,  //106
-  21,  //107
-  20,  //108
-  19,  //109
-  18,  //110
-  17,  //111
-  16,  //112
-  15,  //113
-  14,  //114
-  13,  //115
-  12,  //116
-  11,  //117
-  10,  //118
-  9,  //119
-  8,  //120
-  7,  //121
-  6,  //122
-  5,  //123
-  4,  //124
-  3,  //125
-  2,  //126
-  1,  //127
-  0,  //128
-  0,  //129
-  -1,  //130
-  -2,  //131
-  -3,  //132
-  -4,  //133
-  -5,  //134
-  -6,  //135
-  -7,  //136
-  -8,  //137
-  -9,  //138
-  -10,  //139
-  -11,  //140
-  -12,  //141
-  -13,  //142
-  -14,  //143
-  -15,  //144
-  -16,  //145
-  -17,  //146
-  -18,  //147
-  -19,  //148
-  -20,  //149
-  -21,  //150
-  -22,  //151
-  -23,  //152
-  -24,  //153
-  -25,  //154
-  -26,  //155
-  -27,  //156
-  -28,  //157
-  -29,  //158
-  -30,  //159
-  -31,  //160
-  -32,  //161
-  -33,  //162
-  -34,  //163
-  -35,  //164
-  -36,  //165
-  -37,  //166
-  -38,  //167
-  -39,  //168
-  -40,  //169
-  -41,  //170
-  -42,  //171
-  -43,  //172
-  -44,  //173
-  -45,  //174
-  -46,  //175
-  -47,  //176
-  -48,  //177
-  -49,  //178
-  -50,  //179
-  -51,  //180
-  -52,  //181
-  -53,  //182
-  -54,  //183
-  -55,  //184
-  -56,  //185
-  -57,  //186
-  -58,  //187
-  -59,  //188
-  -60,  //189
-  -61,  //190
-  -62,  //191
-  -63,  //192
-  -64,  //193
-  -65,  //194
-  -66,  //195
-  -67,  //196
-  -68,  //197
-  -69,  //198
-  -70,  //199
-  -71,  //200
-  -72,  //201
-  -73,  //202
-  -74,  //203
-  -75,  //204
-  -76,  //205
-  -77,  //206
-  -78,  //207
-  -79,  //208
-  -80,  //209
-  -81,  //210
-  -82,  //211
-  -83,  //212
-  -84,  //213
-  -85,  //214
-  -86,  //215
-  -87,  //216
-  -88,  //217
-  -89,  //218
-  -90,  //219
-  -91,  //220
-  -92,  //221
-  -93,  //222
-  -94,  //223
-  -95,  //224
-  -96,  //225
-  -97,  //226
-  -98,  //227
-  -99,  //228
-  -100,  //229
-  -101,  //230
-  -102,  //231
-  -103,  //232
-  -104,  //233
-  -105,  //234
-  -106,  //235
-  -107,  //236
-  -108,  //237
-  -109,  //238
-  -110,  //239
-  -111,  //240
-  -112,  //241
-  -113,  //242
-  -114,  //243
-  -115,  //244
-  -116,  //245
-  -117,  //246
-  -118,  //247
-  -119,  //248
-  -120,  //249
-  -121,  //250
-  -122,  //251
-  -123,  //252
-  -124,  //253
-  -125,  //254
-  -127,  //255
-};
-
-const int8_t WT_SQUARE[] PROGMEM = {
-  127,  //0
-  127,  //1
-  127,  //2
-  127,  //3
-  127,  //4
-  127,  //5
-  127,  //6
-  127,  //7
-  127,  //8
-  127,  //9
-  127,  //10
-  127,  //11
-  127,  //12
-  127,  //13
-  127,  //14
-  127,  //15
-  127,  //16
-  127,  //17
-  127,  //18
-  127,  //19
-  127,  //20
-  127,  //21
-  127,  //22
-  127,  //23
-  127,  //24
-  127,  //25
-  127,  //26
-  127,  //27
-  127,  //28
-  127,  //29
-  127,  //30
-  127,  //31
-  127,  //32
-  127,  //33
-  127,  //34
-  127,  //35
-  127,  //36
-  127,  //37
-  127,  //38
-  127,  //39
-  127,  //40
-  127,  //41
-  127,  //42
-  127,  //43
-  127,  //44
-  127,  //45
-  127,  //46
-  127,  //47
-  127,  //48
-  127,  //49
-  127,  //50
-  127,  //51
-  127,  //52
-  127,  //53
-  127,  //54
-  127,  //55
-  127,  //56
-  127,  //57
-  127,  //58
-  127,  //59
-  127,  //60
-  127,  //61
-  127,  //62
-  127,  //63
-  127,  //64
-  127,  //65
-  127,  //66
-  127,  //67
-  127,  //68
-  127,  //69
-  127,  //70
-  127,  //71
-  127,  //72
-  127,  //73
-  127,  //74
-  127,  //75
-  127,  //76
-  127,  //77
-  127,  //78
-  127,  //79
-  127,  //80
-  127,  //81
-  127,  //82
-  127,  //83
-  127,  //84
-  127,  //85
-  127,  //86
-  127,  //87
-  127,  //88
-  127,  //89
-  127,  //90
-  127,  //91
-  127,  //92
-  127,  //93
-  127,  //94
-  127,  //95
-  127,  //96
-  127,  //97
-  127,  //98
-  127,  //99
-  127,  //100
-  127,  //101
-  127,  //102
-  127,  //103
-  127,  //104
-  127,  //105
-  127,  //106
-  127,  //107
-  127,  //108
-  127,  //109
-  127,  //110
-  127,  //111
-  127,  //112
-  127,  //113
-  127,  //114
-  127,  //115
-  127,  //116
-  127,  //117
-  127,  //118
-  127,  //119
-  127,  //120
-  127,  //121
-  127,  //122
-  127,  //123
-  127,  //124
-  127,  //125
-  127,  //126
-  127,  //127
-  -125,  //128
-  -125,  //129
-  -125,  //130
-  -125,  //131
-  -125,  //132
-  -125,  //133
-  -125,  //134
-  -125,  //135
-  -125,  //136
-  -125,  //137
-  -125,  //138
-  -125,  //139
-  -125,  //140
-  -125,  //141
-  -125,  //142
-  -125,  //143
-  -125,  //144
-  -125,  //145
-  -125,  //146
-  -125,  //147
-  -125,  //148
-  -125,  //149
-  -125,  //150
-  -125,  //151
-  -125,  //152
-  -125,  //153
-  -125,  //154
-  -125,  //155
-  -125,  //156
-  -125,  //157
-  -125,  //158
-  -125,  //159
-  -125,  //160
-  -125,  //161
-  -125,  //162
-  -125,  //163
-  -125,  //164
-  -125,  //165
-  -125,  //166
-  -125,  //167
-  -125,  //168
-  -125,  //169
-  -125,  //170
-  -125,  //171
-  -125,  //172
-  -125,  //173
-  -125,  //174
-  -125,  //175
-  -125,  //176
-  -125,  //177
-  -125,  //178
-  -125,  //179
-  -125,  //180
-  -125,  //181
-  -125,  //182
-  -125,  //183
-  -125,  //184
-  -125,  //185
-  -125,  //186
-  -125,  //187
-  -125,  //188
-  -125,  //189
-  -125,  //190
-  -125,  //191
-  -125,  //192
-  -125,  //193
-  -125,  //194
-  -125,  //195
-  -125,  //196
-  -125,  //197
-  -125,  //198
-  -125,  //199
-  -125,  //200
-  -125,  //201
-  -125,  //202
-  -125,  //203
-  -125,  //204
-  -125,  //205
-  -125,  //206
-  -125,  //207
-  -125,  //208
-  -125,  //209
-  -125,  //210
-  -125,  //211
-  -125,  //212
-  -125,  //213
-  -125,  //214
-  -125,  //215
-  -125,  //216
-  -125,  //217
-  -125,  //218
-  -125,  //219
-  -125,  //220
-  -125,  //221
-  -125,  //222
-  -125,  //223
-  -125,  //224
-  -125,  //225
-  -125,  //226
-  -125,  //227
-  -125,  //228
-  -125,  //229
-  -125,  //230
-  -125,  //231
-  -125,  //232
-  -125,  //233
-  -125,  //234
-  -125,  //235
-  -125,  //236
-  -125,  //237
-  -125,  //238
-  -125,  //239
-  -125,  //240
-  -125,  //241
-  -125,  //242
-  -125,  //243
-  -125,  //244
-  -125,  //245
-  -125,  //246
-  -125,  //247
-  -125,  //248
-  -125,  //249
-  -125,  //250
-  -125,  //251
-  -125,  //252
-  -125,  //253
-  -125,  //254
-  -1,  //255
-};
+/**
+ * Sine wave. Only a quarter of it is stored (entries 0 to 64 of 256); the rest
+ * is rebuilt from symmetry. The other shapes are computed on the fly.
+ */
+typedef JNTUB::ProgmemTable<
+  int8_t, 256, JNTUB::TABLE_WRAP, JNTUB::TABLE_QUARTER_WAVE> SineTable;
 
-const int8_t WT_RAMP[] PROGMEM = {
-  -127,  //0
-  -126,  //1
-  -125,  //2
-  -124,  //3
-  -123,  //4
-  -122,  //5
-  -121,  //6
-  -120,  //7
-  -119,  //8
-  -118,  //9
-  -117,  //10
-  -116,  //11
-  -115,  //12
-  -114,  //13
-  -113,  //14
-  -112,  //15
-  -111,  //16
-  -110,  //17
-  -109,  //18
-  -108,  //19
-  -107,  //20
-  -106,  //21
-  -105,  //22
-  -104,  //23
-  -103,  //24
-  -102,  //25
-  -101,  //26
-  -100,  //27
-  -99,  //28
-  -98,  //29
-  -97,  //30
-  -96,  //31
-  -95,  //32
-  -94,  //33
-  -93,  //34
-  -92,  //35
-  -91,  //36
-  -90,  //37
-  -89,  //38
-  -88,  //39
-  -87,  //40
-  -86,  //41
-  -85,  //42
-  -84,  //43
-  -83,  //44
-  -82,  //45
-  -81,  //46
-  -80,  //47
-  -79,  //48
-  -78,  //49
-  -77,  //50
-  -76,  //51
-  -75,  //52
-  -74,  //53
-  -73,  //54
-  -72,  //55
-  -71,  //56
-  -70,  //57
-  -69,  //58
-  -68,  //59
-  -67,  //60
-  -66,  //61
-  -65,  //62
-  -64,  //63
-  -63,  //64
-  -62,  //65
-  -61,  //66
-  -60,  //67
-  -59,  //68
-  -58,  //69
-  -57,  //70
-  -56,  //71
-  -55,  //72
-  -54,  //73
-  -53,  //74
-  -52,  //75
-  -51,  //76
-  -50,  //77
-  -49,  //78
-  -48,  //79
-  -47,  //80
-  -46,  //81
-  -45,  //82
-  -44,  //83
-  -43,  //84
-  -42,  //85
-  -41,  //86
-  -40,  //87
-  -39,  //88
-  -38,  //89
-  -37,  //90
-  -36,  //91
-  -35,  //92
-  -34,  //93
-  -33,  //94
-  -32,  //95
-  -31,  //96
-  -30,  //97
-  -29,  //98
-  -28,  //99
-  -27,  //100
-  -26,  //101
-  -25,  //102
-  -24,  //103
-  -23,  //104
-  -22,  //105
-  -21,  //106
-  -20,  //107
-  -19,  //108
-  -18,  //109
-  -17,  //110
-  -16,  //111
-  -15,  //112
-  -14,  //113
-  -13,  //114
-  -12,  //115
-  -11,  //116
-  -10,  //117
-  -9,  //118
-  -8,  //119
-  -7,  //120
-  -6,  //121
-  -5,  //122
-  -4,  //123
-  -3,  //124
-  -2,  //125
-  -1,  //126
-  0,  //127
-  0,  //128
-  1,  //129
-  2,  //130
-  3,  //131
-  4,  //132
-  5,  //133
-  6,  //134
-  7,  //135
-  8,  //136
-  9,  //137
-  10,  //138
-  11,  //139
-  12,  //140
-  13,  //141
-  14,  //142
-  15,  //143
-  16,  //144
-  17,  //145
-  18,  //146
-  19,  //147
-  20,  //148
-  21,  //149
-  22,  //150
-  23,  //151
-  24,  //152
-  25,  //153
-  26,  //154
-  27,  //155
-  28,  //156
-  29,  //157
-  30,  //158
-  31,  //159
-  32,  //160
-  33,  //161
-  34,  //162
-  35,  //163
-  36,  //164
-  37,  //165
-  38,  //166
-  39,  //167
-  40,  //168
-  41,  //169
-  42,  //170
-  43,  //171
-  44,  //172
-  45,  //173
-  46,  //174
-  47,  //175
-  48,  //176
-  49,  //177
-  50,  //178
-  51,  //179
-  52,  //180
-  53,  //181
-  54,  //182
-  55,  //183
-  56,  //184
-  57,  //185
-  58,  //186
-  59,  //187
-  60,  //188
-  61,  //189
-  62,  //190
-  63,  //191
-  64,  //192
-  65,  //193
-  66,  //194
-  67,  //195
-  68,  //196
-  69,  //197
-  70,  //198
-  71,  //199
-  72,  //200
-  73,  //201
-  74,  //202
-  75,  //203
-  76,  //204
-  77,  //205
-  78,  //206
-  79,  //207
-  80,  //208
-  81,  //209
-  82,  //210
-  83,  //211
-  84,  //212
-  85,  //213
-  86,  //214
-  87,  //215
-  88,  //216
-  89,  //217
-  90,  //218
-  91,  //219
-  92,  //220
-  93,  //221
-  94,  //222
-  95,  //223
-  96,  //224
-  97,  //225
-  98,  //226
-  99,  //227
-  100,  //228
-  101,  //229
-  102,  //230
-  103,  //231
-  104,  //232
-  105,  //233
-  106,  //234
-  107,  //235
-  108,  //236
-  109,  //237
-  110,  //238
-  111,  //239
-  112,  //240
-  113,  //241
-  114,  //242
-  115,  //243
-  116,  //244
-  117,  //245
-  118,  //246
-  119,  //247
-  120,  //248
-  121,  //249
-  122,  //250
-  123,  //251
-  124,  //252
-  125,  //253
-  126,  //254
-  127,  //255
-};
+const int8_t *const WT_SINE_QUARTER = JNTUB::GeneratedTable<
+  JNTUB::SineWave<int8_t, 256>, SineTable::STORED_SIZE>::DATA;
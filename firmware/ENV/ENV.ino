@@ -76,7 +76,7 @@
 #define TIMER_RATE JNTUB::SAMPLE_RATE_10_KHZ
 
 /**
- * Blends between two values with no divides.
+ * Blends between two values with no divides or multiplies.
  * For blend=0, returns a
  * For blend=64, returns average of a and b
  * For blend=128, returns b
@@ -85,17 +85,14 @@ uint8_t blend(uint8_t a, uint8_t b, uint8_t blend)
 {
   if (blend > 128)
     blend = 128;
-  // Guaranteed to not overflow. UINT8_MAX * 64 + UINT8_MAX * 64 == 2^15 - 1
-  uint16_t aScaled = a * (128-blend);
-  uint16_t bScaled = b * blend;
-  return (aScaled + bScaled) >> 7;
+  return JNTUB::lerp<7>(a, b, blend);
 }
 
 /**
  * An envelope generator with customizable envelope shape (curve).
  *
- * The template type CurveT should provide a getValue(x) method that returns
- * 0 for x=0 and 255 for x=255.
+ * The template type CurveT should provide a getValue(phase) method that takes
+ * a 15-bit phase and returns 0 for phase=0 and 255 for phase=32767.
  */
 template<typename CurveT>
 class Envelope {
@@ -152,7 +149,7 @@ public:
 
   inline void update()
   {
-    mClock.update();
+    mClock.tick();
     uint32_t curCycles = mClock.getNumCycles();
 
     if (mState == RISE) {
@@ -171,28 +168,15 @@ public:
     }
     mPrevClockCycles = mClock.getNumCycles();
 
+    // Pass the curve more phase than its tables have entries for.
     // Some of the envelope curves have really jarring and jagged jumps
     // (especially the super-exponential curves), so when attack/decay times are
-    // long, the output is very noticeably jagged.
-    // To fix that, we'll interpolate between two values points in the curve.
+    // long, the output would be very noticeably jagged if we didn't
+    // interpolate between points in the curve.
     // We can do this because FastClock's phase is really granular (32 bits);
     // it's merely the curve tables that lack granularity.
-
     uint16_t phase15bit = mClock.getPhase() >> (JNTUB::FastClock::PHASE_BITS - 15);
-    uint8_t phase8bit = phase15bit >> 7;
-    // 7-bit granularity to determine how far in between two curve points
-    // the envelope currently is. We'll use this value to blend between
-    // two values from the curve.
-    uint8_t phaseRemainder = phase15bit - ((uint16_t)phase8bit<<7);
-
-    uint8_t index = phase8bit;
-    uint8_t valueA = mCurve->getValue(index);
-    uint8_t valueB;
-    if (index == 255)
-      valueB = valueA;
-    else
-      valueB = mCurve->getValue(index+1);
-    uint8_t blended = blend(valueA, valueB, phaseRemainder);
+    uint8_t blended = mCurve->getValue(phase15bit);
 
     if (mState == RISE) {
       mCurVal = blended;
@@ -210,27 +194,73 @@ public:
 };
 
 /**
- * Blends between two curves stored in program space.
+ * Envelope shapes, in SHAPE knob order (from the middle of the knob
+ * outwards). Linear and square curves are computed on the fly; the others
+ * are stored in program space.
+ */
+enum CurveShape {
+  SHAPE_SQUARE,
+  SHAPE_INVERSE,
+  SHAPE_EXPONENTIAL,
+  SHAPE_QUADRATIC,
+  SHAPE_LINEAR,
+  NUM_SHAPES,
+};
+
+typedef JNTUB::ProgmemTable<uint8_t, 256, JNTUB::TABLE_CLAMP> CurveTable;
+
+const CurveTable INVERSE(CURVE_INVERSE);
+const CurveTable EXPONENTIAL(CURVE_EXPONENTIAL);
+const CurveTable QUADRATIC(CURVE_QUADRATIC);
+
+/**
+ * Value (0 to 255) of the given curve at a 15-bit phase. Interpolates between
+ * curve points with the bottom 7 bits.
+ */
+uint8_t curveValue(uint8_t shape, uint16_t phase)
+{
+  switch (shape) {
+    case SHAPE_SQUARE:
+      // Zero until the very end, then a jump to 255 (over the last step,
+      // like interpolating a table with only its last entry set).
+      if (phase < (254U << 7))
+        return 0;
+      if (phase < (255U << 7))
+        return JNTUB::lerp<7>((uint8_t)0, (uint8_t)255, phase & 0x7F);
+      return 255;
+    case SHAPE_INVERSE:
+      return INVERSE.linear<15>(phase);
+    case SHAPE_EXPONENTIAL:
+      return EXPONENTIAL.linear<15>(phase);
+    case SHAPE_QUADRATIC:
+      return QUADRATIC.linear<15>(phase);
+    default:
+      return phase >> 7;
+  }
+}
+
+/**
+ * Blends between two curves.
  */
 class BlendedCurve {
 private:
-  const uint8_t *mCurveA;
-  const uint8_t *mCurveB;
+  uint8_t mShapeA;
+  uint8_t mShapeB;
   uint8_t mBlend;
   bool mFlip;
 
 public:
-  BlendedCurve(const uint8_t *curveA, const uint8_t *curveB)
+  BlendedCurve(uint8_t shapeA, uint8_t shapeB)
   {
-    mCurveA = curveA;
-    mCurveB = curveB;
+    mShapeA = shapeA;
+    mShapeB = shapeB;
     mFlip = false;
   }
 
-  void setCurves(const uint8_t *curveA, const uint8_t *curveB)
+  void setCurves(uint8_t shapeA, uint8_t shapeB)
   {
-    mCurveA = curveA;
-    mCurveB = curveB;
+    mShapeA = shapeA;
+    mShapeB = shapeB;
   }
 
   void setBlend(uint8_t blend)
@@ -243,12 +273,13 @@ public:
     mFlip = flip;
   }
 
-  uint8_t getValue(uint8_t index) const
+  // Takes a 15-bit phase.
+  uint8_t getValue(uint16_t phase) const
   {
     if (mFlip)
-      index = 255 - index;
-    uint8_t valueA = pgm_read_byte_near(mCurveA + index);
-    uint8_t valueB = pgm_read_byte_near(mCurveB + index);
+      phase = 0x7FFF - phase;
+    uint8_t valueA = curveValue(mShapeA, phase);
+    uint8_t valueB = curveValue(mShapeB, phase);
     uint8_t blended = blend(valueA, valueB, mBlend);
     if (mFlip)
       blended = 255 - blended;
@@ -257,7 +288,7 @@ public:
 };
 
 // Attack/decay times in microseconds.
-const uint32_t TIME_CURVE[] = {
+const uint32_t TIME_CURVE[] PROGMEM = {
   100,
   16000,
   48000,
@@ -269,36 +300,39 @@ const uint32_t TIME_CURVE[] = {
   32768000,
 };
 
-const uint8_t *const SHAPE_CURVES[] PROGMEM = {
-  CURVE_SQUARE,
-  CURVE_INVERSE,
-  CURVE_EXPONENTIAL,
-  CURVE_QUADRATIC,
-  CURVE_LINEAR,
-};
-
-JNTUB::DiscreteKnob shapeKnobLeft(NELEM(SHAPE_CURVES)-1, 0);
-JNTUB::DiscreteKnob shapeKnobRight(NELEM(SHAPE_CURVES)-1, 0);
+JNTUB::DiscreteKnob<NUM_SHAPES-1> shapeKnobLeft;
+JNTUB::DiscreteKnob<NUM_SHAPES-1> shapeKnobRight;
 
-JNTUB::CurveKnob<uint32_t> attackKnob(TIME_CURVE, NELEM(TIME_CURVE));
-JNTUB::CurveKnob<uint32_t> decayKnob(TIME_CURVE, NELEM(TIME_CURVE));
+typedef JNTUB::CurveKnob<uint32_t, JNTUB::ProgmemStorage> TimeKnob;
+TimeKnob attackKnob(TIME_CURVE, NELEM(TIME_CURVE));
+TimeKnob decayKnob(TIME_CURVE, NELEM(TIME_CURVE));
 
 JNTUB::EdgeDetector trigger;
 
-BlendedCurve blendedCurve(CURVE_LINEAR, CURVE_LINEAR);
+// Keep ADC noise from wobbling the shape and from having the attack/decay
+// rates recomputed every loop.
+JNTUB::AdaptiveSmoother<1, 5> shapeSmoother;
+JNTUB::AdaptiveSmoother<1, 5> decaySmoother;
+JNTUB::AdaptiveSmoother<1, 5> attackSmoother;
+
+BlendedCurve blendedCurve(SHAPE_LINEAR, SHAPE_LINEAR);
 Envelope<BlendedCurve> env(&blendedCurve);
 
 void setup()
 {
+  shapeSmoother.reset(analogRead(JNTUB::PIN_PARAM3));
+  decaySmoother.reset(analogRead(JNTUB::PIN_PARAM2));
+  attackSmoother.reset(analogRead(JNTUB::PIN_PARAM1));
+
   JNTUB::setUpFastPWM();
   JNTUB::setUpTimerInterrupt(TIMER_RATE);
 }
 
 void loop()
 {
-  uint16_t shapeRaw = analogRead(JNTUB::PIN_PARAM3);
-  uint16_t decayRaw = analogRead(JNTUB::PIN_PARAM2);
-  uint16_t attackRaw = analogRead(JNTUB::PIN_PARAM1);
+  uint16_t shapeRaw = shapeSmoother.update(analogRead(JNTUB::PIN_PARAM3));
+  uint16_t decayRaw = decaySmoother.update(analogRead(JNTUB::PIN_PARAM2));
+  uint16_t attackRaw = attackSmoother.update(analogRead(JNTUB::PIN_PARAM1));
 
   uint8_t curveSelect;
   uint8_t blend;
@@ -315,15 +349,16 @@ void loop()
     blend = shapeKnobRight.mapInnerValue(0, 128);
     blendedCurve.setFlip(false);
   }
-  const uint8_t *curveA = pgm_read_word(&SHAPE_CURVES[curveSelect]);
-  const uint8_t *curveB = pgm_read_word(&SHAPE_CURVES[curveSelect+1]);
-  blendedCurve.setCurves(curveA, curveB);
+  blendedCurve.setCurves(curveSelect, curveSelect+1);
   blendedCurve.setBlend(blend);
 
   attackKnob.update(attackRaw);
   decayKnob.update(decayRaw);
-  env.setAttack(attackKnob.getValue());
-  env.setDecay(decayKnob.getValue());
+  // Converting times to clock rates takes a divide, so only do it on change.
+  if (attackKnob.valueChanged())
+    env.setAttack(attackKnob.getValue());
+  if (decayKnob.valueChanged())
+    env.setDecay(decayKnob.getValue());
 }
 
 ISR(TIMER_INTERRUPT)
@@ -21,1297 +21,51 @@
   Description: Envelope shape data
 
  */
-const uint8_t CURVE_LINEAR[256] PROGMEM = {
-  0,  // 0
-  1,  // 1
-  2,  // 2
-  3,  // 3
-  4,  // 4
-  5,  // 5
-  6,  // 6
-  7,  // 7
-  8,  // 8
-  9,  // 9
-  10,  // 10
-  11,  // 11
-  12,  // 12
-  13,  // 13
-  14,  // 14
-  15,  // 15
-  16,  // 16
-  17,  // 17
-  18,  // 18
-  19,  // 19
-  20,  // 20
-  21,  // 21
-  22,  // 22
-  23,  // 23
-  24,  // 24
-  25,  // 25
-  26,  // 26
-  27,  // 27
-  28,  // 28
-  29,  // 29
-  30,  // 30
-  31,  // 31
-  32,  // 32
-  33,  // 33
-  34,  // 34
-  35,  // 35
-  36,  // 36
-  37,  // 37
-  38,  // 38
-  39,  // 39
-  40,  // 40
-  41,  // 41
-  42,  // 42
-  43,  // 43
-  44,  // 44
-  45,  // 45
-  46,  // 46
-  47,  // 47
-  48,  // 48
-  49,  // 49
-  50,  // 50
-  51,  // 51
-  52,  // 52
-  53,  // 53
-  54,  // 54
-  55,  // 55
-  56,  // 56
-  57,  // 57
-  58,  // 58
-  59,  // 59
-  60,  // 60
-  61,  // 61
-  62,  // 62
-  63,  // 63
-  64,  // 64
-  65,  // 65
-  66,  // 66
-  67,  // 67
-  68,  // 68
-  69,  // 69
-  70,  // 70
-  71,  // 71
-  72,  // 72
-  73,  // 73
-  74,  // 74
-  75,  // 75
-  76,  // 76
-  77,  // 77
-  78,  // 78
-  79,  // 79
-  80,  // 80
-  81,  // 81
-  82,  // 82
-  83,  // 83
-  84,  // 84
-  85,  // 85
-  86,  // 86
-  87,  // 87
-  88,  // 88
-  89,  // 89
-  90,  // 90
-  91,  // 91
-  92,  // 92
-  93,  // 93
-  94,  // 94
-  95,  // 95
-  96,  // 96
-  97,  // 97
-  98,  // 98
-  99,  // 99
-  100,  // 100
-  101,  // 101
-  102,  // 102
-  103,  // 103
-  104,  // 104
-  105,  // 105
-  106,  // 106
-  107,  // 107
-  108,  // 108
-  109,  // 109
-  110,  // 110
-  111,  // 111
-  112,  // 112
-  113,  // 113
-  114,  // 114
-  115,  // 115
-  116,  // 116
-  117,  // 117
-  118,  // 118
-  119,  // 119
-  120,  // 120
-  121,  // 121
-  122,  // 122
-  123,  // 123
-  124,  // 124
-  125,  // 125
-  126,  // 126
-  127,  // 127
-  128,  // 128
-  129,  // 129
-  130,  // 130
-  131,  // 131
-  132,  // 132
-  133,  // 133
-  134,  // 134
-  135,  // 135
-  136,  // 136
-  137,  // 137
-  138,  // 138
-  139,  // 139
-  140,  // 140
-  141,  // 141
-  142,  // 142
-  143,  // 143
-  144,  // 144
-  145,  // 145
-  146,  // 146
-  147,  // 147
-  148,  // 148
-  149,  // 149
-  150,  // 150
-  151,  // 151
-  152,  // 152
-  153,  // 153
-  154,  // 154
-  155,  // 155
-  156,  // 156
-  157,  // 157
-  158,  // 158
-  159,  // 159
-  160,  // 160
-  161,  // 161
-  162,  // 162
-  163,  // 163
-  164,  // 164
-  165,  // 165
-  166,  // 166
-  167,  // 167
-  168,  // 168
-  169,  // 169
-  170,  // 170
-  171,  // 171
-  172,  // 172
-  173,  // 173
-  174,  // 174
-  175,  // 175
-  176,  // 176
-  177,  // 177
-  178,  // 178
-  179,  // 179
-  180,  // 180
-  181,  // 181
-  182,  // 182
-  183,  // 183
-  184,  // 184
-  185,  // 185
-  186,  // 186
-  187,  // 187
-  188,  // 188
-  189,  // 189
-  190,  // 190
-  191,  // 191
-  192,  // 192
-  193,  // 193
-  194,  // 194
-  195,  // 195
-  196,  // 196
-  197,  // 197
-  198,  // 198
-  199,  // 199
-  200,  // 200
-  201,  // 201
-  202,  // 202
-  203,  // 203
-  204,  // 204
-  205,  // 205
-  206,  // 206
-  207,  // 207
-  208,  // 208
-  209,  // 209
-  210,  // 210
-  211,  // 211
-  212,  // 212
-  213,  // 213
-  214,  // 214
-  215,  // 215
-  216,  // 216
-  217,  // 217
-  218,  // 218
-  219,  // 219
-  220,  // 220
-  221,  // 221
-  222,  // 222
-  223,  // 223
-  224,  // 224
-  225,  // 225
-  226,  // 226
-  227,  // 227
-  228,  // 228
-  229,  // 229
-  230,  // 230
-  231,  // 231
-  232,  // 232
-  233,  // 233
-  234,  // 234
-  235,  // 235
-  236,  // 236
-  237,  // 237
-  238,  // 238
-  239,  // 239
-  240,  // 240
-  241,  // 241
-  242,  // 242
-  243,  // 243
-  244,  // 244
-  245,  // 245
-  246,  // 246
-  247,  // 247
-  248,  // 248
-  249,  // 249
-  250,  // 250
-  251,  // 251
-  252,  // 252
-  253,  // 253
-  254,  // 254
-  255,  // 255
-};
+// JoyfulNoise Tiny Utility Board Library
+#include <JNTUB.h>
 
-const uint8_t CURVE_QUADRATIC[256] PROGMEM = {
-  0,  // 0
-  0,  // 1
-  0,  // 2
-  0,  // 3
-  0,  // 4
-  0,  // 5
-  0,  // 6
-  0,  // 7
-  0,  // 8
-  0,  // 9
-  0,  // 10
-  0,  // 11
-  0,  // 12
-  0,  // 13
-  0,  // 14
-  0,  // 15
-  1,  // 16
-  1,  // 17
-  1,  // 18
-  1,  // 19
-  1,  // 20
-  1,  // 21
-  1,  // 22
-  2,  // 23
-  2,  // 24
-  2,  // 25
-  2,  // 26
-  2,  // 27
-  3,  // 28
-  3,  // 29
-  3,  // 30
-  3,  // 31
-  4,  // 32
-  4,  // 33
-  4,  // 34
-  4,  // 35
-  5,  // 36
-  5,  // 37
-  5,  // 38
-  5,  // 39
-  6,  // 40
-  6,  // 41
-  6,  // 42
-  7,  // 43
-  7,  // 44
-  7,  // 45
-  8,  // 46
-  8,  // 47
-  9,  // 48
-  9,  // 49
-  9,  // 50
-  10,  // 51
-  10,  // 52
-  10,  // 53
-  11,  // 54
-  11,  // 55
-  12,  // 56
-  12,  // 57
-  13,  // 58
-  13,  // 59
-  14,  // 60
-  14,  // 61
-  15,  // 62
-  15,  // 63
-  16,  // 64
-  16,  // 65
-  17,  // 66
-  17,  // 67
-  18,  // 68
-  18,  // 69
-  19,  // 70
-  19,  // 71
-  20,  // 72
-  20,  // 73
-  21,  // 74
-  21,  // 75
-  22,  // 76
-  23,  // 77
-  23,  // 78
-  24,  // 79
-  25,  // 80
-  25,  // 81
-  26,  // 82
-  26,  // 83
-  27,  // 84
-  28,  // 85
-  28,  // 86
-  29,  // 87
-  30,  // 88
-  30,  // 89
-  31,  // 90
-  32,  // 91
-  33,  // 92
-  33,  // 93
-  34,  // 94
-  35,  // 95
-  36,  // 96
-  36,  // 97
-  37,  // 98
-  38,  // 99
-  39,  // 100
-  39,  // 101
-  40,  // 102
-  41,  // 103
-  42,  // 104
-  43,  // 105
-  43,  // 106
-  44,  // 107
-  45,  // 108
-  46,  // 109
-  47,  // 110
-  48,  // 111
-  49,  // 112
-  49,  // 113
-  50,  // 114
-  51,  // 115
-  52,  // 116
-  53,  // 117
-  54,  // 118
-  55,  // 119
-  56,  // 120
-  57,  // 121
-  58,  // 122
-  59,  // 123
-  60,  // 124
-  61,  // 125
-  62,  // 126
-  63,  // 127
-  64,  // 128
-  65,  // 129
-  66,  // 130
-  67,  // 131
-  68,  // 132
-  69,  // 133
-  70,  // 134
-  71,  // 135
-  72,  // 136
-  73,  // 137
-  74,  // 138
-  75,  // 139
-  76,  // 140
-  77,  // 141
-  78,  // 142
-  79,  // 143
-  81,  // 144
-  82,  // 145
-  83,  // 146
-  84,  // 147
-  85,  // 148
-  86,  // 149
-  87,  // 150
-  89,  // 151
-  90,  // 152
-  91,  // 153
-  92,  // 154
-  93,  // 155
-  95,  // 156
-  96,  // 157
-  97,  // 158
-  98,  // 159
-  100,  // 160
-  101,  // 161
-  102,  // 162
-  103,  // 163
-  105,  // 164
-  106,  // 165
-  107,  // 166
-  108,  // 167
-  110,  // 168
-  111,  // 169
-  112,  // 170
-  114,  // 171
-  115,  // 172
-  116,  // 173
-  118,  // 174
-  119,  // 175
-  121,  // 176
-  122,  // 177
-  123,  // 178
-  125,  // 179
-  126,  // 180
-  127,  // 181
-  129,  // 182
-  130,  // 183
-  132,  // 184
-  133,  // 185
-  135,  // 186
-  136,  // 187
-  138,  // 188
-  139,  // 189
-  141,  // 190
-  142,  // 191
-  144,  // 192
-  145,  // 193
-  147,  // 194
-  148,  // 195
-  150,  // 196
-  151,  // 197
-  153,  // 198
-  154,  // 199
-  156,  // 200
-  157,  // 201
-  159,  // 202
-  160,  // 203
-  162,  // 204
-  164,  // 205
-  165,  // 206
-  167,  // 207
-  169,  // 208
-  170,  // 209
-  172,  // 210
-  173,  // 211
-  175,  // 212
-  177,  // 213
-  178,  // 214
-  180,  // 215
-  182,  // 216
-  183,  // 217
-  185,  // 218
-  187,  // 219
-  189,  // 220
-  190,  // 221
-  192,  // 222
-  194,  // 223
-  196,  // 224
-  197,  // 225
-  199,  // 226
-  201,  // 227
-  203,  // 228
-  204,  // 229
-  206,  // 230
-  208,  // 231
-  210,  // 232
-  212,  // 233
-  213,  // 234
-  215,  // 235
-  217,  // 236
-  219,  // 237
-  221,  // 238
-  223,  // 239
-  225,  // 240
-  226,  // 241
-  228,  // 242
-  230,  // 243
-  232,  // 244
-  234,  // 245
-  236,  // 246
-  238,  // 247
-  240,  // 248
-  242,  // 249
-  244,  // 250
-  246,  // 251
-  248,  // 252
-  250,  // 253
-  252,  // 254
-  254,  // 255
-};
+/*
+ * Envelope curves, 256 entries each, from 0 to 255. Computed at compile time.
+ * See curves.png for what they look like. The linear and square curves are
+ * computed on the fly, so they don't need tables.
+ */
 
-const uint8_t CURVE_EXPONENTIAL[256] PROGMEM = {
-  0,  // 0
-  0,  // 1
-  0,  // 2
-  0,  // 3
-  0,  // 4
-  0,  // 5
-  0,  // 6
-  0,  // 7
-  0,  // 8
-  0,  // 9
-  0,  // 10
-  0,  // 11
-  0,  // 12
-  0,  // 13
-  0,  // 14
-  0,  // 15
-  0,  // 16
-  0,  // 17
-  0,  // 18
-  0,  // 19
-  0,  // 20
-  0,  // 21
-  0,  // 22
-  0,  // 23
-  0,  // 24
-  0,  // 25
-  0,  // 26
-  0,  // 27
-  0,  // 28
-  0,  // 29
-  0,  // 30
-  0,  // 31
-  1,  // 32
-  1,  // 33
-  1,  // 34
-  1,  // 35
-  1,  // 36
-  1,  // 37
-  1,  // 38
-  1,  // 39
-  1,  // 40
-  1,  // 41
-  1,  // 42
-  1,  // 43
-  1,  // 44
-  1,  // 45
-  1,  // 46
-  1,  // 47
-  1,  // 48
-  1,  // 49
-  1,  // 50
-  2,  // 51
-  2,  // 52
-  2,  // 53
-  2,  // 54
-  2,  // 55
-  2,  // 56
-  2,  // 57
-  2,  // 58
-  2,  // 59
-  2,  // 60
-  2,  // 61
-  2,  // 62
-  2,  // 63
-  3,  // 64
-  3,  // 65
-  3,  // 66
-  3,  // 67
-  3,  // 68
-  3,  // 69
-  3,  // 70
-  3,  // 71
-  3,  // 72
-  3,  // 73
-  3,  // 74
-  4,  // 75
-  4,  // 76
-  4,  // 77
-  4,  // 78
-  4,  // 79
-  4,  // 80
-  4,  // 81
-  4,  // 82
-  5,  // 83
-  5,  // 84
-  5,  // 85
-  5,  // 86
-  5,  // 87
-  5,  // 88
-  5,  // 89
-  6,  // 90
-  6,  // 91
-  6,  // 92
-  6,  // 93
-  6,  // 94
-  6,  // 95
-  7,  // 96
-  7,  // 97
-  7,  // 98
-  7,  // 99
-  7,  // 100
-  7,  // 101
-  8,  // 102
-  8,  // 103
-  8,  // 104
-  8,  // 105
-  8,  // 106
-  9,  // 107
-  9,  // 108
-  9,  // 109
-  9,  // 110
-  10,  // 111
-  10,  // 112
-  10,  // 113
-  10,  // 114
-  11,  // 115
-  11,  // 116
-  11,  // 117
-  11,  // 118
-  12,  // 119
-  12,  // 120
-  12,  // 121
-  13,  // 122
-  13,  // 123
-  13,  // 124
-  13,  // 125
-  14,  // 126
-  14,  // 127
-  15,  // 128
-  15,  // 129
-  15,  // 130
-  16,  // 131
-  16,  // 132
-  16,  // 133
-  17,  // 134
-  17,  // 135
-  18,  // 136
-  18,  // 137
-  18,  // 138
-  19,  // 139
-  19,  // 140
-  20,  // 141
-  20,  // 142
-  21,  // 143
-  21,  // 144
-  22,  // 145
-  22,  // 146
-  23,  // 147
-  23,  // 148
-  24,  // 149
-  24,  // 150
-  25,  // 151
-  25,  // 152
-  26,  // 153
-  27,  // 154
-  27,  // 155
-  28,  // 156
-  28,  // 157
-  29,  // 158
-  30,  // 159
-  31,  // 160
-  31,  // 161
-  32,  // 162
-  33,  // 163
-  33,  // 164
-  34,  // 165
-  35,  // 166
-  36,  // 167
-  37,  // 168
-  37,  // 169
-  38,  // 170
-  39,  // 171
-  40,  // 172
-  41,  // 173
-  42,  // 174
-  43,  // 175
-  44,  // 176
-  45,  // 177
-  46,  // 178
-  47,  // 179
-  48,  // 180
-  49,  // 181
-  50,  // 182
-  51,  // 183
-  52,  // 184
-  53,  // 185
-  55,  // 186
-  56,  // 187
-  57,  // 188
-  58,  // 189
-  60,  // 190
-  61,  // 191
-  63,  // 192
-  64,  // 193
-  65,  // 194
-  67,  // 195
-  68,  // 196
-  70,  // 197
-  71,  // 198
-  73,  // 199
-  75,  // 200
-  76,  // 201
-  78,  // 202
-  80,  // 203
-  81,  // 204
-  83,  // 205
-  85,  // 206
-  87,  // 207
-  89,  // 208
-  91,  // 209
-  93,  // 210
-  95,  // 211
-  97,  // 212
-  99,  // 213
-  102,  // 214
-  104,  // 215
-  106,  // 216
-  108,  // 217
-  111,  // 218
-  113,  // 219
-  116,  // 220
-  118,  // 221
-  121,  // 222
-  124,  // 223
-  127,  // 224
-  129,  // 225
-  132,  // 226
-  135,  // 227
-  138,  // 228
-  141,  // 229
-  144,  // 230
-  147,  // 231
-  151,  // 232
-  154,  // 233
-  157,  // 234
-  161,  // 235
-  164,  // 236
-  168,  // 237
-  172,  // 238
-  176,  // 239
-  180,  // 240
-  183,  // 241
-  188,  // 242
-  192,  // 243
-  196,  // 244
-  200,  // 245
-  205,  // 246
-  209,  // 247
-  214,  // 248
-  218,  // 249
-  223,  // 250
-  228,  // 251
-  233,  // 252
-  238,  // 253
-  244,  // 254
-  249,  // 255
+// 256 * (x / 256)^2
+struct QuadraticCurve {
+  typedef uint8_t Type;
+
+  static constexpr uint8_t value(unsigned x)
+  {
+    return (x * x) >> 8;
+  }
 };
 
-const uint8_t CURVE_INVERSE[256] PROGMEM = {
-  0,  // 0
-  0,  // 1
-  0,  // 2
-  0,  // 3
-  0,  // 4
-  0,  // 5
-  0,  // 6
-  0,  // 7
-  0,  // 8
-  0,  // 9
-  0,  // 10
-  0,  // 11
-  0,  // 12
-  0,  // 13
-  0,  // 14
-  0,  // 15
-  0,  // 16
-  0,  // 17
-  0,  // 18
-  0,  // 19
-  0,  // 20
-  0,  // 21
-  0,  // 22
-  0,  // 23
-  0,  // 24
-  0,  // 25
-  0,  // 26
-  0,  // 27
-  0,  // 28
-  0,  // 29
-  0,  // 30
-  0,  // 31
-  0,  // 32
-  0,  // 33
-  0,  // 34
-  0,  // 35
-  0,  // 36
-  1,  // 37
-  1,  // 38
-  1,  // 39
-  1,  // 40
-  1,  // 41
-  1,  // 42
-  1,  // 43
-  1,  // 44
-  1,  // 45
-  1,  // 46
-  1,  // 47
-  1,  // 48
-  1,  // 49
-  1,  // 50
-  1,  // 51
-  1,  // 52
-  1,  // 53
-  1,  // 54
-  1,  // 55
-  1,  // 56
-  1,  // 57
-  1,  // 58
-  1,  // 59
-  1,  // 60
-  1,  // 61
-  1,  // 62
-  1,  // 63
-  2,  // 64
-  2,  // 65
-  2,  // 66
-  2,  // 67
-  2,  // 68
-  2,  // 69
-  2,  // 70
-  2,  // 71
-  2,  // 72
-  2,  // 73
-  2,  // 74
-  2,  // 75
-  2,  // 76
-  2,  // 77
-  2,  // 78
-  2,  // 79
-  2,  // 80
-  2,  // 81
-  2,  // 82
-  2,  // 83
-  2,  // 84
-  2,  // 85
-  3,  // 86
-  3,  // 87
-  3,  // 88
-  3,  // 89
-  3,  // 90
-  3,  // 91
-  3,  // 92
-  3,  // 93
-  3,  // 94
-  3,  // 95
-  3,  // 96
-  3,  // 97
-  3,  // 98
-  3,  // 99
-  3,  // 100
-  3,  // 101
-  3,  // 102
-  4,  // 103
-  4,  // 104
-  4,  // 105
-  4,  // 106
-  4,  // 107
-  4,  // 108
-  4,  // 109
-  4,  // 110
-  4,  // 111
-  4,  // 112
-  4,  // 113
-  4,  // 114
-  4,  // 115
-  4,  // 116
-  5,  // 117
-  5,  // 118
-  5,  // 119
-  5,  // 120
-  5,  // 121
-  5,  // 122
-  5,  // 123
-  5,  // 124
-  5,  // 125
-  5,  // 126
-  5,  // 127
-  6,  // 128
-  6,  // 129
-  6,  // 130
-  6,  // 131
-  6,  // 132
-  6,  // 133
-  6,  // 134
-  6,  // 135
-  6,  // 136
-  6,  // 137
-  7,  // 138
-  7,  // 139
-  7,  // 140
-  7,  // 141
-  7,  // 142
-  7,  // 143
-  7,  // 144
-  7,  // 145
-  7,  // 146
-  8,  // 147
-  8,  // 148
-  8,  // 149
-  8,  // 150
-  8,  // 151
-  8,  // 152
-  8,  // 153
-  9,  // 154
-  9,  // 155
-  9,  // 156
-  9,  // 157
-  9,  // 158
-  9,  // 159
-  10,  // 160
-  10,  // 161
-  10,  // 162
-  10,  // 163
-  10,  // 164
-  10,  // 165
-  11,  // 166
-  11,  // 167
-  11,  // 168
-  11,  // 169
-  11,  // 170
-  12,  // 171
-  12,  // 172
-  12,  // 173
-  12,  // 174
-  12,  // 175
-  13,  // 176
-  13,  // 177
-  13,  // 178
-  13,  // 179
-  14,  // 180
-  14,  // 181
-  14,  // 182
-  15,  // 183
-  15,  // 184
-  15,  // 185
-  15,  // 186
-  16,  // 187
-  16,  // 188
-  16,  // 189
-  17,  // 190
-  17,  // 191
-  18,  // 192
-  18,  // 193
-  18,  // 194
-  19,  // 195
-  19,  // 196
-  20,  // 197
-  20,  // 198
-  20,  // 199
-  21,  // 200
-  21,  // 201
-  22,  // 202
-  22,  // 203
-  23,  // 204
-  24,  // 205
-  24,  // 206
-  25,  // 207
-  26,  // 208
-  26,  // 209
-  27,  // 210
-  28,  // 211
-  28,  // 212
-  29,  // 213
-  30,  // 214
-  31,  // 215
-  32,  // 216
-  33,  // 217
-  34,  // 218
-  35,  // 219
-  36,  // 220
-  37,  // 221
-  39,  // 222
-  40,  // 223
-  42,  // 224
-  43,  // 225
-  45,  // 226
-  46,  // 227
-  48,  // 228
-  50,  // 229
-  53,  // 230
-  55,  // 231
-  58,  // 232
-  60,  // 233
-  63,  // 234
-  67,  // 235
-  70,  // 236
-  74,  // 237
-  79,  // 238
-  84,  // 239
-  90,  // 240
-  96,  // 241
-  103,  // 242
-  112,  // 243
-  122,  // 244
-  133,  // 245
-  147,  // 246
-  164,  // 247
-  186,  // 248
-  213,  // 249
-  250,  // 250
-  255,  // 251
-  255,  // 252
-  255,  // 253
-  255,  // 254
-  255,  // 255
+// 256^(x / 256) - 1
+struct ExponentialCurve {
+  typedef uint8_t Type;
+
+  static constexpr uint8_t value(unsigned x)
+  {
+    // The tiny bias keeps float rounding from pushing the exact integer
+    // points (x = 32, 64, ...) just below the integer.
+    return JNTUB::constFloor(
+      JNTUB::constExp(x * (8 * JNTUB::LN2_F) / 256) - 1 + 0.0005f);
+  }
 };
 
-const uint8_t CURVE_SQUARE[256] PROGMEM = {
-  0,  // 0
-  0,  // 1
-  0,  // 2
-  0,  // 3
-  0,  // 4
-  0,  // 5
-  0,  // 6
-  0,  // 7
-  0,  // 8
-  0,  // 9
-  0,  // 10
-  0,  // 11
-  0,  // 12
-  0,  // 13
-  0,  // 14
-  0,  // 15
-  0,  // 16
-  0,  // 17
-  0,  // 18
-  0,  // 19
-  0,  // 20
-  0,  // 21
-  0,  // 22
-  0,  // 23
-  0,  // 24
-  0,  // 25
-  0,  // 26
-  0,  // 27
-  0,  // 28
-  0,  // 29
-  0,  // 30
-  0,  // 31
-  0,  // 32
-  0,  // 33
-  0,  // 34
-  0,  // 35
-  0,  // 36
-  0,  // 37
-  0,  // 38
-  0,  // 39
-  0,  // 40
-  0,  // 41
-  0,  // 42
-  0,  // 43
-  0,  // 44
-  0,  // 45
-  0,  // 46
-  0,  // 47
-  0,  // 48
-  0,  // 49
-  0,  // 50
-  0,  // 51
-  0,  // 52
-  0,  // 53
-  0,  // 54
-  0,  // 55
-  0,  // 56
-  0,  // 57
-  0,  // 58
-  0,  // 59
-  0,  // 60
-  0,  // 61
-  0,  // 62
-  0,  // 63
-  0,  // 64
-  0,  // 65
-  0,  // 66
-  0,  // 67
-  0,  // 68
-  0,  // 69
-  0,  // 70
-  0,  // 71
-  0,  // 72
-  0,  // 73
-  0,  // 74
-  0,  // 75
-  0,  // 76
-  0,  // 77
-  0,  // 78
-  0,  // 79
-  0,  // 80
-  0,  // 81
-  0,  // 82
-  0,  // 83
-  0,  // 84
-  0,  // 85
-  0,  // 86
-  0,  // 87
-  0,  // 88
-  0,  // 89
-  0,  // 90
-  0,  // 91
-  0,  // 92
-  0,  // 93
-  0,  // 94
-  0,  // 95
-  0,  // 96
-  0,  // 97
-  0,  // 98
-  0,  // 99
-  0,  // 100
-  0,  // 101
-  0,  // 102
-  0,  // 103
-  0,  // 104
-  0,  // 105
-  0,  // 106
-  0,  // 107
-  0,  // 108
-  0,  // 109
-  0,  // 110
-  0,  // 111
-  0,  // 112
-  0,  // 113
-  0,  // 114
-  0,  // 115
-  0,  // 116
-  0,  // 117
-  0,  // 118
-  0,  // 119
-  0,  // 120
-  0,  // 121
-  0,  // 122
-  0,  // 123
-  0,  // 124
-  0,  // 125
-  0,  // 126
-  0,  // 127
-  0,  // 128
-  0,  // 129
-  0,  // 130
-  0,  // 131
-  0,  // 132
-  0,  // 133
-  0,  // 134
-  0,  // 135
-  0,  // 136
-  0,  // 137
-  0,  // 138
-  0,  // 139
-  0,  // 140
-  0,  // 141
-  0,  // 142
-  0,  // 143
-  0,  // 144
-  0,  // 145
-  0,  // 146
-  0,  // 147
-  0,  // 148
-  0,  // 149
-  0,  // 150
-  0,  // 151
-  0,  // 152
-  0,  // 153
-  0,  // 154
-  0,  // 155
-  0,  // 156
-  0,  // 157
-  0,  // 158
-  0,  // 159
-  0,  // 160
-  0,  // 161
-  0,  // 162
-  0,  // 163
-  0,  // 164
-  0,  // 165
-  0,  // 166
-  0,  // 167
-  0,  // 168
-  0,  // 169
-  0,  // 170
-  0,  // 171
-  0,  // 172
-  0,  // 173
-  0,  // 174
-  0,  // 175
-  0,  // 176
-  0,  // 177
-  0,  // 178
-  0,  // 179
-  0,  // 180
-  0,  // 181
-  0,  // 182
-  0,  // 183
-  0,  // 184
-  0,  // 185
-  0,  // 186
-  0,  // 187
-  0,  // 188
-  0,  // 189
-  0,  // 190
-  0,  // 191
-  0,  // 192
-  0,  // 193
-  0,  // 194
-  0,  // 195
-  0,  // 196
-  0,  // 197
-  0,  // 198
-  0,  // 199
-  0,  // 200
-  0,  // 201
-  0,  // 202
-  0,  // 203
-  0,  // 204
-  0,  // 205
-  0,  // 206
-  0,  // 207
-  0,  // 208
-  0,  // 209
-  0,  // 210
-  0,  // 211
-  0,  // 212
-  0,  // 213
-  0,  // 214
-  0,  // 215
-  0,  // 216
-  0,  // 217
-  0,  // 218
-  0,  // 219
-  0,  // 220
-  0,  // 221
-  0,  // 222
-  0,  // 223
-  0,  // 224
-  0,  // 225
-  0,  // 226
-  0,  // 227
-  0,  // 228
-  0,  // 229
-  0,  // 230
-  0,  // 231
-  0,  // 232
-  0,  // 233
-  0,  // 234
-  0,  // 235
-  0,  // 236
-  0,  // 237
-  0,  // 238
-  0,  // 239
-  0,  // 240
-  0,  // 241
-  0,  // 242
-  0,  // 243
-  0,  // 244
-  0,  // 245
-  0,  // 246
-  0,  // 247
-  0,  // 248
-  0,  // 249
-  0,  // 250
-  0,  // 251
-  0,  // 252
-  0,  // 253
-  0,  // 254
-  255,  // 255
+// 1536 / (256 - x) - 6, clipped to 255
+struct InverseCurve {
+  typedef uint8_t Type;
+
+  static constexpr uint8_t value(unsigned x)
+  {
+    return (1536 / (256 - x) - 6 > 255) ? 255 : 1536 / (256 - x) - 6;
+  }
 };
+
+const uint8_t *const CURVE_QUADRATIC =
+  JNTUB::GeneratedTable<QuadraticCurve, 256>::DATA;
+const uint8_t *const CURVE_EXPONENTIAL =
+  JNTUB::GeneratedTable<ExponentialCurve, 256>::DATA;
+const uint8_t *const CURVE_INVERSE =
+  JNTUB::GeneratedTable<InverseCurve, 256>::DATA;
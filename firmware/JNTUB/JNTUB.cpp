@@ -248,6 +248,15 @@ void setUp10BitPWM()
   setUpFastPWM(PWM_RATE_7_KHZ);
 #endif // F_CPU
 
+#elif defined(__AVR_ATmega328P__) || defined(__AVR_ATmega328__)
+  // TIMSK1 – Timer/Counter1 Interrupt Mask Register.
+  //  - TOIE1: Timer/Counter1 Overflow Interrupt Enable
+  bitSet(TIMSK1, TOIE1);
+
+  // No PLL here, so the PWM generator only runs at 62.5 KHz. That's 256
+  // cycles per period, which leaves plenty of room for the ISR.
+  setUpFastPWM(PWM_RATE_62_KHZ);
+
 #else
 #error Precise PWM not implemented for this board
 #endif
@@ -305,120 +314,93 @@ ISR(TIMER1_OVF_vect)
  * ============================================================================
  */
 
-#define TIMER0_PRESCALE_1 (1<<CS00)
-#define TIMER0_PRESCALE_8 (2<<CS00)
-#define TIMER0_PRESCALE_64 (3<<CS00)
+// Clock select bits of TCCR0B for a Timer/Counter0 prescaler.
+static constexpr uint8_t timer0ClockSelect(uint16_t prescaler)
+{
+  return ((prescaler == 1) ? 1 :
+          (prescaler == 8) ? 2 :
+          (prescaler == 64) ? 3 :
+          (prescaler == 256) ? 4 :
+          5) << CS00;
+}
+
+// Prescaler and TOP for a sample rate, worked out at compile time from
+// F_CPU (see timerPrescaler() and timerPeriod()).
+template<SampleRate Rate>
+static inline void setUpTimer0()
+{
+  static_assert(timerPeriod(Rate) >= 1 && timerPeriod(Rate) <= 256,
+                "sample rate not possible at this clock frequency");
+  static const uint8_t CLOCK_SELECT = timer0ClockSelect(timerPrescaler(Rate));
+  static const uint8_t TOP = timerPeriod(Rate) - 1;
+  TCCR0B |= CLOCK_SELECT;
+  OCR0A = TOP;
+}
 
 void setUpTimerInterrupt(SampleRate rate)
 {
-#if defined(__AVR_ATtiny85__)
+#if defined(__AVR_ATtiny85__) || \
+    defined(__AVR_ATmega328P__) || defined(__AVR_ATmega328__)
 
   TCCR0A = 3<<WGM00;  // Fast PWM
   TCCR0B = 1<<WGM02;  // Overflow on TOP
 
-#if F_CPU == 16000000
-
   switch(rate) {
     case SAMPLE_RATE_40_KHZ:
-      TCCR0B |= TIMER0_PRESCALE_8;
-      OCR0A = 49;   // Divide by 50 (2M / 50 = 40k)
+      setUpTimer0<SAMPLE_RATE_40_KHZ>();
       break;
     case SAMPLE_RATE_20_KHZ:
-      TCCR0B |= TIMER0_PRESCALE_8;
-      OCR0A = 99;   // Divide by 100 (2M / 100 = 20k)
+      setUpTimer0<SAMPLE_RATE_20_KHZ>();
       break;
     case SAMPLE_RATE_10_KHZ:
-      TCCR0B |= TIMER0_PRESCALE_8;
-      OCR0A = 199;   // Divide by 200 (2M / 200 = 10k)
+      setUpTimer0<SAMPLE_RATE_10_KHZ>();
       break;
     case SAMPLE_RATE_8_KHZ:
-      TCCR0B |= TIMER0_PRESCALE_8;
-      OCR0A = 249;  // Divide by 250 (2M / 250 = 8k)
+      setUpTimer0<SAMPLE_RATE_8_KHZ>();
       break;
     case SAMPLE_RATE_4_KHZ:
-      TCCR0B |= TIMER0_PRESCALE_64;
-      OCR0A = 61;   // Divide by 62 (250k / 62 = 4,032) **
-    case SAMPLE_RATE_1_KHZ:
-      TCCR0B |= TIMER0_PRESCALE_64;
-      OCR0A = 249;   // Divide by 250 (250k / 250 = 1k)
-    default:
-      break;
-  }
-
-#elif F_CPU == 8000000
-
-  switch(rate) {
-    case SAMPLE_RATE_40_KHZ:
-      TCCR0B |= TIMER0_PRESCALE_8;
-      OCR0A = 24;   // Divide by 25 (1M / 25 = 40k)
-      break;
-    case SAMPLE_RATE_20_KHZ:
-      TCCR0B |= TIMER0_PRESCALE_8;
-      OCR0A = 49;   // Divide by 50 (1M / 50 = 20k)
-      break;
-    case SAMPLE_RATE_10_KHZ:
-      TCCR0B |= TIMER0_PRESCALE_8;
-      OCR0A = 99;   // Divide by 100 (1M / 100 = 10k)
-      break;
-    case SAMPLE_RATE_8_KHZ:
-      TCCR0B |= TIMER0_PRESCALE_8;
-      OCR0A = 124;  // Divide by 125 (1M / 125 = 8k)
-      break;
-    case SAMPLE_RATE_4_KHZ:
-      TCCR0B |= TIMER0_PRESCALE_8;
-      OCR0A = 249;  // Divide by 250 (1M / 125 = 4k)
+      // Not exact at 16 MHz: 250k / 62 = 4,032 Hz
+      setUpTimer0<SAMPLE_RATE_4_KHZ>();
       break;
     case SAMPLE_RATE_1_KHZ:
-      TCCR0B |= TIMER0_PRESCALE_64;
-      OCR0A = 124;  // Divide by 125 (125k / 125 = 1k)
+      setUpTimer0<SAMPLE_RATE_1_KHZ>();
       break;
     default:
       break;
   }
 
-#elif F_CPU == 1000000
-
-  switch(rate) {
-    case SAMPLE_RATE_40_KHZ:
-      TCCR0B |= TIMER0_PRESCALE_1;
-      OCR0A = 24;   // Divide by 25 (1M / 25 = 40k)
-      break;
-    case SAMPLE_RATE_20_KHZ:
-      TCCR0B |= TIMER0_PRESCALE_1;
-      OCR0A = 49;   // Divide by 50 (1M / 50 = 20k)
-      break;
-    case SAMPLE_RATE_10_KHZ:
-      TCCR0B |= TIMER0_PRESCALE_1;
-      OCR0A = 99;   // Divide by 100 (1M / 100 = 10k)
-      break;
-    case SAMPLE_RATE_8_KHZ:
-      TCCR0B |= TIMER0_PRESCALE_1;
-      OCR0A = 124;  // Divide by 125 (1M / 125 = 8k)
-      break;
-    case SAMPLE_RATE_4_KHZ:
-      TCCR0B |= TIMER0_PRESCALE_1;
-      OCR0A = 249;  // Divide by 250 (1M / 125 = 4k)
-      break;
-    case SAMPLE_RATE_1_KHZ:
-      TCCR0B |= TIMER0_PRESCALE_8;
-      OCR0A = 124;  // Divide by 125 (125k / 125 = 1k)
-      break;
-    default:
-      break;
-  }
-
-#else
-#error setUpTimerInterrupt not implemented for this clock frequency
-#endif // F_CPU
-
+#if defined(__AVR_ATtiny85__)
   bitSet(TIMSK, OCIE0A);  // Enable compare match int.
   bitClear(TIMSK, TOIE0); // Disable overflow int.
+#else
+  // Same Timer/Counter0 as the ATtiny85, but its own mask register. Like on
+  // the ATtiny85, this takes millis() and micros() away from the sketch.
+  bitSet(TIMSK0, OCIE0A);  // Enable compare match int.
+  bitClear(TIMSK0, TOIE0); // Disable overflow int.
+#endif
 
 #else
 #error setUpTimerInterrupt not implemented for this board
 #endif
 }
 
+void setUpGateInterrupt()
+{
+#if defined(__AVR_ATtiny85__)
+
+  bitSet(PCMSK, PCINT0);  // GATE/TRG is PB0
+  bitSet(GIMSK, PCIE);    // Enable pin change int.
+
+#elif defined(__AVR_ATmega328P__) || defined(__AVR_ATmega328__)
+
+  bitSet(PCMSK0, PCINT0); // GATE/TRG is PB0 (Uno pin 8)
+  bitSet(PCICR, PCIE0);   // Enable pin change int. for PCINT[7:0]
+
+#else
+#error setUpGateInterrupt not implemented for this board
+#endif
+}
+
 /**
  * ===========================================================================
  *
@@ -427,13 +409,34 @@ void setUpTimerInterrupt(SampleRate rate)
  * ===========================================================================
  */
 
+/**
+ * ============================================================================
+ * FixedTraits
+ * ============================================================================
+ */
+
+// Out-of-class definitions, since the limits are picked in ?: expressions
+// (e.g. addSaturating()), which take their address.
+const int8_t FixedTraits<int8_t>::MIN_VALUE;
+const int8_t FixedTraits<int8_t>::MAX_VALUE;
+const uint8_t FixedTraits<uint8_t>::MIN_VALUE;
+const uint8_t FixedTraits<uint8_t>::MAX_VALUE;
+const int16_t FixedTraits<int16_t>::MIN_VALUE;
+const int16_t FixedTraits<int16_t>::MAX_VALUE;
+const uint16_t FixedTraits<uint16_t>::MIN_VALUE;
+const uint16_t FixedTraits<uint16_t>::MAX_VALUE;
+const int32_t FixedTraits<int32_t>::MIN_VALUE;
+const int32_t FixedTraits<int32_t>::MAX_VALUE;
+const uint32_t FixedTraits<uint32_t>::MIN_VALUE;
+const uint32_t FixedTraits<uint32_t>::MAX_VALUE;
+
 /**
  * ============================================================================
  * DiscreteKnob
  * ============================================================================
  */
 
-DiscreteKnob::DiscreteKnob(uint16_t numValues, uint8_t hysteresis)
+DiscreteKnob<0, 0>::DiscreteKnob(uint16_t numValues, uint8_t hysteresis)
   : mMaxVal(0), mHysteresis(0), mCurVal(0), mPrevVal(0), mCurValRaw(0),
     mStep(0), mCurLower(0), mCurUpper(0)
 {
@@ -441,7 +444,7 @@ DiscreteKnob::DiscreteKnob(uint16_t numValues, uint8_t hysteresis)
   setHysteresis(hysteresis);
 }
 
-void DiscreteKnob::setNumValues(uint16_t numValues)
+void DiscreteKnob<0, 0>::setNumValues(uint16_t numValues)
 {
   numValues = constrain(numValues, 1, 256);
   mMaxVal = numValues - 1;
@@ -450,24 +453,24 @@ void DiscreteKnob::setNumValues(uint16_t numValues)
   updateThresholds();
 }
 
-void DiscreteKnob::setHysteresis(uint8_t hysteresis)
+void DiscreteKnob<0, 0>::setHysteresis(uint8_t hysteresis)
 {
   mHysteresis = constrain(hysteresis, 0, mStep / 2);
   updateThresholds();
 }
 
-void DiscreteKnob::update(uint16_t value)
+void DiscreteKnob<0, 0>::update(uint16_t value)
 {
   mCurValRaw = value;
+  mPrevVal = mCurVal;
 
   if (value < mCurLower || value > mCurUpper) {
-    mPrevVal = mCurVal;
     mCurVal = value / mStep;
     updateThresholds();
   }
 }
 
-void DiscreteKnob::updateThresholds()
+void DiscreteKnob<0, 0>::updateThresholds()
 {
   uint16_t lower = mCurVal * mStep;
 
@@ -484,31 +487,91 @@ void DiscreteKnob::updateThresholds()
   }
 }
 
-uint8_t DiscreteKnob::getValue() const
+uint8_t DiscreteKnob<0, 0>::getValue() const
 {
   return mCurVal;
 }
 
-uint16_t DiscreteKnob::getValueRaw() const
+uint16_t DiscreteKnob<0, 0>::getValueRaw() const
 {
   return mCurValRaw;
 }
 
-bool DiscreteKnob::valueChanged() const
+bool DiscreteKnob<0, 0>::valueChanged() const
 {
   return mPrevVal != mCurVal;
 }
 
-uint32_t DiscreteKnob::mapValue(uint32_t lower, uint32_t upper) const
+uint32_t DiscreteKnob<0, 0>::mapValue(uint32_t lower, uint32_t upper) const
 {
   return map(mCurVal, 0, mMaxVal, lower, upper);
 }
 
-uint32_t DiscreteKnob::mapInnerValue(uint32_t lower, uint32_t upper) const
+uint32_t DiscreteKnob<0, 0>::mapInnerValue(uint32_t lower, uint32_t upper) const
 {
   return map(mCurValRaw, mCurLower, mCurUpper, lower, upper);
 }
 
+/**
+ * ============================================================================
+ * Random
+ * ============================================================================
+ */
+
+Random::Random(uint16_t seed)
+{
+  this->seed(seed);
+}
+
+void Random::seed(uint16_t seed)
+{
+  mState = seed ? seed : 1;
+  mBits = 0;
+  mBitsLeft = 0;
+}
+
+uint16_t Random::next()
+{
+  // See George Marsaglia, "Xorshift RNGs" (2003).
+  // The << 8 is just a byte move.
+  uint16_t x = mState;
+  x ^= x << 7;
+  x ^= x >> 9;
+  x ^= x << 8;
+  mState = x;
+  return x;
+}
+
+bool Random::nextBit()
+{
+  if (mBitsLeft == 0) {
+    mBits = next();
+    mBitsLeft = 16;
+  }
+  bool bit = mBits & 0x01;
+  mBits >>= 1;
+  --mBitsLeft;
+  return bit;
+}
+
+uint8_t Random::nextBits(uint8_t n)
+{
+  // Throw away leftovers rather than stitching two states together.
+  if (mBitsLeft < n) {
+    mBits = next();
+    mBitsLeft = 16;
+  }
+  uint8_t bits = mBits & ((1 << n) - 1);
+  mBits >>= n;
+  mBitsLeft -= n;
+  return bits;
+}
+
+uint8_t Random::nextByte()
+{
+  return nextBits(8);
+}
+
 /**
  * ============================================================================
  * EdgeDetector
@@ -591,10 +654,16 @@ void Stopwatch::setStartTime(uint32_t startTime)
 
 Clock::Clock(uint32_t period)
 {
-  mPeriod = period;
+  mPeriod = 0;
+  mIncrement = 0;
+  setPeriod(period);
+  mPhase = 0;
+  mLastTime = 0;
+  mHaveTime = false;
   mDuty = (uint8_t)(PHASE_MAX / 2);
-  mCurPhase = 0;
   mRunning = false;
+  mPrevState = 0;
+  mEdges = 0;
 }
 
 uint32_t Clock::getPeriod() const
@@ -603,12 +672,16 @@ uint32_t Clock::getPeriod() const
 }
 void Clock::setPeriod(uint32_t period)
 {
+  if (period == mPeriod)
+    return;
   mPeriod = period;
+  // Rounded down, so that increment * (period - 1) can't overflow.
+  mIncrement = period ? UINT32_MAX / period : 0;
 }
 
 uint8_t Clock::getPhase() const
 {
-  return mCurPhase;
+  return mPhase >> 24;
 }
 
 uint8_t Clock::getDuty() const
@@ -622,20 +695,27 @@ void Clock::setDuty(uint8_t duty)
 
 bool Clock::getState() const
 {
-  return mCurPhase < mDuty;
+  return getPhase() < mDuty;
 }
 bool Clock::isRising() const
 {
-  return !mPrevState && getState();
+  // Every new period starts high, unless the duty is 0.
+  return ((mEdges & EDGE_RISING) && mDuty) || (!mPrevState && getState());
 }
 bool Clock::isFalling() const
 {
-  return mPrevState && !getState();
+  return (mEdges & EDGE_FALLING) || (mPrevState && !getState());
 }
 
 void Clock::start()
 {
+  if (mRunning)
+    return;
+  // Start from the beginning of a period at the next update(), rather than
+  // counting however long the clock was stopped (or the time since boot).
   mRunning = true;
+  mPhase = 0;
+  mHaveTime = false;
 }
 
 void Clock::stop()
@@ -645,29 +725,50 @@ void Clock::stop()
 
 void Clock::sync(uint8_t phase)
 {
-  mCurPhase = phase;
-
-  // Adjust the start time of the current period, otherwise updates will
-  // proceed as if phase had not been modified
-  uint32_t timeWithinPeriod = mCurPhase * mPeriod / PHASE_MAX;
-  mStopwatch.setStartTime(mStopwatch.getRealTime() - timeWithinPeriod);
+  mPhase = (uint32_t)phase << 24;
 }
 
 void Clock::update(uint32_t time)
 {
-  mStopwatch.update(time);
+  // Unsigned subtraction also handles the time overflowing.
+  bool started = !mHaveTime;
+  uint32_t delta = time - mLastTime;
+  mLastTime = time;
+  mHaveTime = true;
+
+  mPrevState = getState();
+  mEdges = 0;
 
   if (!mRunning || mPeriod == 0)
     return;
 
-  mPrevState = getState();
+  if (started) {
+    // First update since start(): the first period begins now.
+    mEdges = EDGE_RISING;
+    return;
+  }
+
+  // Whole periods since the last update only happen when updates are
+  // further apart than a period, so the divide here is rare.
+  bool skipped = false;
+  if (delta >= mPeriod) {
+    delta %= mPeriod;
+    skipped = true;
+  }
+
+  uint32_t distance = delta * mIncrement;
+  uint32_t phase = mPhase + distance;
 
-  uint32_t timeWithinPeriod = mStopwatch.getTime() % mPeriod;
-  mCurPhase = timeWithinPeriod * PHASE_MAX / mPeriod;
+  // The phase reached the duty (travelled at least (duty - phase) mod 2^32,
+  // counting 0 as 2^32) during the update.
+  uint32_t duty = (uint32_t)mDuty << 24;
+  uint32_t toDutyMinusOne = duty - mPhase - 1;
+  if (skipped || phase < mPhase)
+    mEdges |= EDGE_RISING;
+  if (mDuty && (skipped || toDutyMinusOne < distance))
+    mEdges |= EDGE_FALLING;
 
-  // Start counting a new period if one is just starting
-  if (isRising())
-    mStopwatch.reset();
+  mPhase = phase;
 }
 
 /**
@@ -680,11 +781,9 @@ FastClock::FastClock(uint16_t tickRateHz)
   : mMicrosPerTick(calculateMicrosPerTick(tickRateHz))
 {
   mRate = 0;
-  mDuty = PHASE_MAX / 2;
-  mCycles = 0;
-  mCurPhase = 0;
+  mDuty = (uint32_t)1 << (PHASE_BITS - 1);
   mRunning = false;
-  mPrevState = false;
+  mEdges = 0;
 }
 
 uint16_t FastClock::calculateMicrosPerTick(uint16_t tickRateHz)
@@ -702,7 +801,7 @@ uint16_t FastClock::getMicrosPerTick() const
 
 uint32_t FastClock::microsToRate(uint32_t micros) const
 {
-  uint32_t phasePerMicro = PHASE_MAX / micros;
+  uint32_t phasePerMicro = UINT32_MAX / micros;
   return mMicrosPerTick * phasePerMicro;
 }
 
@@ -714,6 +813,8 @@ uint32_t FastClock::getRate() const
 void FastClock::setRate(uint32_t rate)
 {
   mRate = rate;
+  if (mRunning)
+    mPhase.setIncrement(rate);
 }
 
 uint32_t FastClock::getDuty() const
@@ -728,55 +829,125 @@ void FastClock::setDuty(uint32_t duty)
 
 uint32_t FastClock::getNumCycles() const
 {
-  return mCycles;
+  uint8_t sreg = SREG;
+  noInterrupts();
+  uint32_t cycles = mPhase.getNumCycles();
+  SREG = sreg;
+  return cycles;
 }
 
 void FastClock::start()
 {
   mRunning = true;
+  mPhase.setIncrement(mRate);
 }
 
 void FastClock::stop()
 {
   mRunning = false;
+  mPhase.setIncrement(0);
 }
 
-void FastClock::sync(uint32_t phase=0)
+void FastClock::sync(uint32_t phase)
 {
-  phase = phase & (PHASE_MAX-1);
-  mCurPhase = phase;
+  // Jumping from low to high starts a new period, same as wrapping around.
+  bool wasHigh = getState();
+  mPhase.setPhase(phase);
+  if (!wasHigh && getState())
+    mEdges |= EDGE_RISING;
+}
+
+void FastClock::sync(uint32_t phase, uint8_t elapsed)
+{
+  // increment * elapsed / 256, without a 32x32 multiply
+  uint32_t increment = mPhase.getIncrement();
+  uint32_t sinceEdge = (increment >> 8) * elapsed +
+                       (((increment & 0xFF) * elapsed) >> 8);
+  sync(phase + sinceEdge);
 }
 
 bool FastClock::getState() const
 {
-  return mCurPhase < mDuty;
+  return mPhase.getPhase() < mDuty;
 }
 
 bool FastClock::isRising() const
 {
-  return getState() & !mPrevState;
+  // Every new period starts high, unless the duty is 0.
+  return (mEdges & EDGE_RISING) && mDuty;
 }
 
 bool FastClock::isFalling() const
 {
-  return !getState() & mPrevState;
+  if (mEdges & EDGE_ADVANCED)
+    return mEdges & EDGE_FALLING;
+
+  // Phase crossed the duty during the last tick. A tick that wrapped around
+  // can also have crossed it, either before or after the wrap.
+  uint32_t phase = mPhase.getPhase();
+  uint32_t prevPhase = phase - mPhase.getIncrement();
+  uint32_t duty = mDuty;
+  if (mEdges & EDGE_RISING)
+    return duty && (prevPhase < duty || phase >= duty);
+  return prevPhase < duty && phase >= duty;
+}
+
+uint32_t FastClock::ticksSinceRising() const
+{
+  uint32_t increment = mPhase.getIncrement();
+  if (!increment)
+    return 0;
+  // Ticks since the phase wrapped past 0
+  return mPhase.getPhase() / increment;
+}
+
+uint32_t FastClock::ticksSinceFalling() const
+{
+  uint32_t increment = mPhase.getIncrement();
+  if (!increment)
+    return 0;
+  // Ticks since the phase passed the duty
+  return (mPhase.getPhase() - mDuty) / increment;
 }
 
 uint32_t FastClock::getPhase() const
 {
-  return mCurPhase;
+  return mPhase.getPhase();
 }
 
 void FastClock::tick()
 {
-  if (mRunning) {
-    mPrevState = getState();
-    mCurPhase += mRate;
-    if (mCurPhase >= PHASE_MAX) {
-      mCurPhase -= PHASE_MAX;
-      ++mCycles;
-    }
-  }
+  mEdges = mPhase.tick() ? EDGE_RISING : 0;
+}
+
+void FastClock::advance(uint16_t n)
+{
+  uint32_t phase = mPhase.getPhase();
+  uint32_t increment = mPhase.getIncrement();
+
+  // Distance the phase travels, increment * n, is up to 48 bits:
+  // distanceHigh * 2^32 + distanceLow. Two 16x16 multiplies rather than
+  // a 32x32 one.
+  uint32_t low = (uint32_t)(uint16_t)increment * n;
+  uint32_t high = (uint32_t)(uint16_t)(increment >> 16) * n;
+  uint32_t distanceLow = low + (high << 16);
+  uint16_t distanceHigh = (high >> 16) + (distanceLow < low);
+
+  uint32_t newPhase = phase + distanceLow;
+  uint16_t wraps = distanceHigh + (newPhase < phase);
+
+  // The phase reached the duty (i.e. travelled at least
+  // (duty - phase) mod 2^32, counting 0 as 2^32) during the block.
+  uint32_t toDutyMinusOne = mDuty - phase - 1;
+  bool fell = mDuty && (distanceHigh || toDutyMinusOne < distanceLow);
+
+  mPhase.setPhase(newPhase);
+  mPhase.addCycles(wraps);
+  mEdges = EDGE_ADVANCED;
+  if (wraps)
+    mEdges |= EDGE_RISING;
+  if (fell)
+    mEdges |= EDGE_FALLING;
 }
 
 /**
@@ -825,11 +996,89 @@ void FastStopwatch::tick()
   ++mTicks;
 }
 
+void FastStopwatch::advance(uint16_t n)
+{
+  mTicks += n;
+}
+
 uint32_t FastStopwatch::getNumTicks() const
 {
   return mTicks;
 }
 
+/**
+ * ============================================================================
+ * EdgeTimer
+ * ============================================================================
+ */
+
+EdgeTimer::EdgeTimer()
+{
+  mCount = 0;
+  mCaptured = false;
+  mScale = 0;
+}
+
+void EdgeTimer::begin()
+{
+  // The timer interrupt fires when the count hits TOP (OCR0A), after which
+  // it starts over from 0.
+  mScale = 65536UL / ((uint16_t)OCR0A + 1);
+}
+
+void EdgeTimer::capture()
+{
+  uint8_t count = TCNT0;
+  // If the timer interrupt is already pending, the count has wrapped
+  // around; this edge belongs right at the start of the coming tick.
+#if defined(__AVR_ATtiny85__)
+  if (TIFR & (1 << OCF0A))
+#else
+  if (TIFR0 & (1 << OCF0A))
+#endif
+    count = OCR0A;
+  mCount = count;
+  mCaptured = true;
+}
+
+uint8_t EdgeTimer::elapsed()
+{
+  // The timer interrupt may have re-enabled interrupts, so don't let a new
+  // edge land between reading the count and clearing the flag.
+  uint8_t sreg = SREG;
+  noInterrupts();
+  uint8_t now = TCNT0;
+  uint8_t count = mCount;
+  bool captured = mCaptured;
+  mCaptured = false;
+  SREG = sreg;
+
+  // A count at or below the current one means the edge came after this
+  // tick's compare match, while this interrupt was already running (e.g.
+  // with other interrupts nested in it). It belongs to this tick.
+  if (!captured || count <= now)
+    return 0;
+  // (TOP - count) / (TOP + 1) of a tick ago, as UQ0.8
+  uint8_t countsAgo = OCR0A - count;
+  return (uint16_t)(countsAgo * mScale) >> 8;
+}
+
+/**
+ * Rate (see FastClock) for a period given in UQ24.8 ticks.
+ * **SLOW** (32-bit divides)
+ */
+static uint32_t rateForPeriod(uint32_t period)
+{
+  if (period < 256)
+    return UINT32_MAX;
+  if (period >= ((uint32_t)1 << 24))
+    return UINT32_MAX / (period >> 8);
+  // UINT32_MAX * 256 / period, in two steps so nothing overflows.
+  uint32_t quotient = UINT32_MAX / period;
+  uint32_t remainder = UINT32_MAX % period;
+  return (quotient << 8) + ((remainder << 8) / period);
+}
+
 /**
  * ============================================================================
  * FastClockApproximator
@@ -842,6 +1091,7 @@ FastClockApproximator::FastClockApproximator(uint16_t tickRateHz)
   mHighTicks = 0;
   mLowTicks = 0;
   mTmpTicks = 0;
+  mEdgeElapsed = 0;
   mStopwatch.start();
 }
 
@@ -853,9 +1103,16 @@ void FastClockApproximator::calculateRateAndDuty(
   uint32_t lowTicks = mLowTicks;
   interrupts();
 
+  // Both in UQ24.8 ticks
   uint32_t periodLength = highTicks + lowTicks;
-  uint32_t clockRate = FastClock::PHASE_MAX / periodLength;
-  uint32_t duty = clockRate * highTicks;
+  if (!periodLength) {
+    // No complete period seen yet
+    *rateOut = 0;
+    *dutyOut = (uint32_t)1 << 31;
+    return;
+  }
+  uint32_t clockRate = rateForPeriod(periodLength);
+  uint32_t duty = (UINT32_MAX / periodLength) * highTicks;
 
   *rateOut = clockRate;
   *dutyOut = duty;
@@ -873,28 +1130,50 @@ bool FastClockApproximator::isFalling() const
 
 uint32_t FastClockApproximator::getHighTicks() const
 {
-  return mHighTicks;
+  return mHighTicks >> 8;
 }
 
 uint32_t FastClockApproximator::getLowTicks() const
 {
-  return mLowTicks;
+  return mLowTicks >> 8;
+}
+
+void FastClockApproximator::getPeriod(
+    uint32_t *highOut, uint32_t *lowOut) const
+{
+  noInterrupts();
+  *highOut = mHighTicks;
+  *lowOut = mLowTicks;
+  interrupts();
 }
 
-void FastClockApproximator::tick(bool gate)
+void FastClockApproximator::tick(bool gate, uint8_t elapsed)
 {
-  mStopwatch.tick();
+  advance(1, gate, elapsed);
+}
+
+void FastClockApproximator::advance(uint16_t n, bool gate, uint8_t elapsed)
+{
+  mStopwatch.advance(n);
   mEdgeDetector.update(gate);
 
+  if (!mEdgeDetector.isRising() && !mEdgeDetector.isFalling())
+    return;
+
+  // Time since the last edge. The stopwatch runs from the tick that saw
+  // the last edge to the tick that saw this one; each edge happened its
+  // elapsed fraction of a tick before then.
+  uint32_t sinceEdge = (mStopwatch.getNumTicks() << 8) + mEdgeElapsed - elapsed;
+  mStopwatch.reset();
+  mEdgeElapsed = elapsed;
+
   if (mEdgeDetector.isRising()) {
     // Rising edge
     mHighTicks = mTmpTicks;
-    mLowTicks = mStopwatch.getNumTicks();
-    mStopwatch.reset();
-  } else if (mEdgeDetector.isFalling()) {
+    mLowTicks = sinceEdge;
+  } else {
     // Falling edge
-    mTmpTicks = mStopwatch.getNumTicks();
-    mStopwatch.reset();
+    mTmpTicks = sinceEdge;
   }
 }
 
@@ -907,11 +1186,10 @@ void FastClockApproximator::tick(bool gate)
 ClockDetector::ClockDetector(uint16_t tickRateHz)
   : mApproximator(tickRateHz), mTicksPerMillis(tickRateHz / 1000)
 {
-  mPrevHighTicks = 0;
-  mPrevLowTicks = 0;
+  clearPeriods();
+  mLastPeriod = 0;
   mTicksInPeriod = 0;
   mIsClock = false;
-  mNumGoodPeriods = 0;
 }
 
 bool ClockDetector::isClock() const
@@ -934,57 +1212,490 @@ bool ClockDetector::isFalling() const
   return mApproximator.isFalling();
 }
 
-void ClockDetector::tick(bool gate)
+void ClockDetector::tick(bool gate, uint8_t elapsed)
 {
-  mApproximator.tick(gate);
-
-  if (!mIsClock) {
-    // Determine if we should recognize the input as a clock signal.
-    if (mApproximator.isRising()) {
-      // A period just completed. See if it was good.
-      if (mostRecentPeriodWasGood())
-        ++mNumGoodPeriods;
-      else
-        mNumGoodPeriods = 1;
+  mApproximator.tick(gate, elapsed);
 
-      if (mNumGoodPeriods >= 3)
+  if (mApproximator.isRising()) {
+    // A period just completed.
+    uint32_t highTicks = mApproximator.getHighTicks();
+    uint32_t period = highTicks + mApproximator.getLowTicks();
+    mTicksInPeriod = 0;
+    mLastPeriod = period;
+
+    addPeriod(period);
+    if (!mIsClock) {
+      // Duty cycle must have been at least 1/8 of the period.
+      bool dutyOk = highTicks >= (period >> 3);
+      if (!periodsAreSteady()) {
+        // Tempo changed (or this isn't a clock). Start over from this period.
+        clearPeriods();
+        addPeriod(period);
+      } else if (dutyOk && mNumPeriods >= WINDOW) {
         mIsClock = true;
+      }
     }
-  } else {
+  } else if (mIsClock) {
     // Determine if we should stop recognizing the input as a clock signal.
     ++mTicksInPeriod;
-    uint32_t fourPeriods = (mPrevHighTicks + mPrevLowTicks) << 2;
+    uint32_t fourPeriods = mLastPeriod << 2;
     uint32_t twoSeconds = (uint32_t)mTicksPerMillis << 11;  // ticks * 2048
     uint32_t threshold = max(fourPeriods, twoSeconds);
-    if (mTicksInPeriod >= threshold)
+    if (mTicksInPeriod >= threshold) {
       mIsClock = false;
+      clearPeriods();
+    }
   }
+}
 
-  if (mApproximator.isRising()) {
-    mTicksInPeriod = 0;
-    mPrevHighTicks = mApproximator.getHighTicks();
-    mPrevLowTicks = mApproximator.getLowTicks();
+void ClockDetector::addPeriod(uint32_t period)
+{
+  // The running sum stays up to date without summing the whole window.
+  mPeriodSum += period - mPeriods[mPeriodIndex];
+  mPeriods[mPeriodIndex] = period;
+  mPeriodIndex = (mPeriodIndex + 1) & (WINDOW - 1);
+  if (mNumPeriods < WINDOW)
+    ++mNumPeriods;
+}
+
+void ClockDetector::clearPeriods()
+{
+  for (uint8_t i = 0; i < WINDOW; ++i)
+    mPeriods[i] = 0;
+  mPeriodSum = 0;
+  mPeriodIndex = 0;
+  mNumPeriods = 0;
+}
+
+bool ClockDetector::periodsAreSteady() const
+{
+  // Each period must be within 1/2^TOLERANCE_BITS of the mean (or
+  // MAX_TOLERANCE_MS, whichever is less), i.e.
+  //   |period - sum / n| <= (sum / n) >> TOLERANCE_BITS
+  // Multiplied through by n (at most WINDOW) to avoid dividing.
+  uint32_t tolerance = mPeriodSum >> TOLERANCE_BITS;
+  // Slow periods are held to a fixed margin instead, so irregular triggers
+  // a second apart don't pass for a clock.
+  uint16_t maxTolerance =
+    (uint16_t)mTicksPerMillis * MAX_TOLERANCE_MS * mNumPeriods;
+  if (tolerance > maxTolerance)
+    tolerance = maxTolerance;
+  uint8_t index = mPeriodIndex;
+  for (uint8_t i = 0; i < mNumPeriods; ++i) {
+    index = (index - 1) & (WINDOW - 1);
+    uint32_t scaled = mPeriods[index] * mNumPeriods;
+    if (absdiff(scaled, mPeriodSum) > tolerance)
+      return false;
   }
+  return true;
 }
 
-bool ClockDetector::mostRecentPeriodWasGood() const
+/**
+ * ============================================================================
+ * ClockPLL
+ * ============================================================================
+ */
+
+ClockPLL::ClockPLL(uint16_t tickRateHz)
+  : mFollower(tickRateHz)
 {
-  // Get stats from the period that just finished.
-  uint32_t highTicks = mApproximator.getHighTicks();
-  uint32_t lowTicks = mApproximator.getLowTicks();
+  mTicksSinceEdge = 0;
+  mEdgeElapsed = 0;
+  mEdgeCycles = 0;
+  mBandwidth = 2;
+  mGoodEdges = 0;
+  mLocked = false;
+  mHavePeriod = false;
+  mNewPeriod = 0;
+  mRateBits = 0;
+  mClockRising = false;
+  mFollower.start();
+}
 
-  // Period length must be roughly the same as the previous period.
-  uint32_t thisPeriod = highTicks + lowTicks;
-  uint32_t lastPeriod = mPrevHighTicks + mPrevLowTicks;
-  uint32_t lengthDifference = absdiff(thisPeriod, lastPeriod);
-  if (lengthDifference > ((uint32_t)mTicksPerMillis << MARGIN_OF_ERROR_BITS))
-    return false;
+void ClockPLL::setBandwidth(uint8_t bandwidth)
+{
+  uint8_t sreg = SREG;
+  noInterrupts();
+  mBandwidth = constrain(bandwidth, 1, 8);
+  SREG = sreg;
+}
+
+void ClockPLL::update()
+{
+  uint8_t sreg = SREG;
+  noInterrupts();
+  uint32_t period = mNewPeriod;
+  mNewPeriod = 0;
+  SREG = sreg;
+
+  if (period) {
+    uint32_t newRate = rateForPeriod(period);
+    noInterrupts();
+    // Leave the rate to track() if the loop locked in the meantime.
+    if (!mLocked)
+      mFollower.setRate(newRate);
+    SREG = sreg;
+  }
 
-  // Duty cycle must have been at least 1/8 of the period.
-  if (highTicks < (thisPeriod >> 3))
+  noInterrupts();
+  uint32_t rate = mFollower.getRate();
+  SREG = sreg;
+  uint8_t bits = 0;
+  for (; rate > 1; rate >>= 1)
+    ++bits;
+  mRateBits = bits;
+}
+
+bool ClockPLL::isLocked() const
+{
+  return mLocked;
+}
+
+const FastClock &ClockPLL::getClock() const
+{
+  return mFollower;
+}
+
+uint32_t ClockPLL::getRate() const
+{
+  return mFollower.getRate();
+}
+
+uint32_t ClockPLL::getPhase() const
+{
+  return mFollower.getPhase();
+}
+
+bool ClockPLL::isRising() const
+{
+  return mEdgeDetector.isRising();
+}
+
+bool ClockPLL::isFalling() const
+{
+  return mEdgeDetector.isFalling();
+}
+
+bool ClockPLL::isClockRising() const
+{
+  return mClockRising;
+}
+
+void ClockPLL::tick(bool gate, uint8_t elapsed)
+{
+  mFollower.tick();
+  ++mTicksSinceEdge;
+  mEdgeDetector.update(gate);
+  // Until lock, the follower is resynced to every edge before it gets to
+  // wrap around by itself, so the edges stand in for its periods.
+  mClockRising = mLocked && mFollower.isRising();
+
+  if (!mEdgeDetector.isRising()) {
+    // Input stopped?
+    if (mLocked &&
+        mFollower.getNumCycles() - mEdgeCycles >= PERIODS_TO_UNLOCK) {
+      mLocked = false;
+      mGoodEdges = 0;
+    }
+    return;
+  }
+
+  // Where the follower was relative to the start of its period when the
+  // edge happened. It should be right on 0; positive means the follower is
+  // ahead.
+  uint32_t increment = mFollower.getRate();
+  uint32_t sinceEdge = (increment >> 8) * elapsed +
+                       (((increment & 0xFF) * elapsed) >> 8);
+  int32_t error = (int32_t)(mFollower.getPhase() - sinceEdge);
+
+  if (mLocked && !track(error)) {
+    mLocked = false;
+    mGoodEdges = 0;
+  }
+  if (!mLocked) {
+    acquire(error, elapsed);
+    mClockRising = true;
+  }
+
+  mTicksSinceEdge = 0;
+  mEdgeElapsed = elapsed;
+  mEdgeCycles = mFollower.getNumCycles();
+}
+
+void ClockPLL::acquire(int32_t error, uint8_t elapsed)
+{
+  uint32_t distance = (error < 0) ? -error : error;
+  // With no rate set yet, the follower sits at phase 0 and the error is
+  // trivially 0, so the edge proves nothing.
+  if (mHavePeriod && mFollower.getRate() && distance < LOCK_ERROR) {
+    if (++mGoodEdges >= EDGES_TO_LOCK)
+      mLocked = true;
+  } else {
+    mGoodEdges = 0;
+  }
+
+  // Start over from the last period. update() sets the rate for it.
+  if (mHavePeriod)
+    mNewPeriod = (mTicksSinceEdge << 8) + mEdgeElapsed - elapsed;
+  mFollower.sync(0, elapsed);
+  mHavePeriod = true;
+}
+
+bool ClockPLL::track(int32_t error)
+{
+  uint32_t distance = (error < 0) ? -error : error;
+  if (distance > UNLOCK_ERROR)
     return false;
 
+  // Proportional: take out part of the phase error right away.
+  mFollower.sync(mFollower.getPhase() - (error >> mBandwidth));
+
+  // Integral: a phase error of e (out of 2^32) over one period means the
+  // rate is off by about e * rate / 2^32. Approximate rate / 2^32 by its
+  // highest set bit instead of multiplying. The corrections are small, so
+  // update() finding that bit once per loop is plenty.
+  uint32_t rate = mFollower.getRate();
+  uint8_t shift = 32 + 2 * mBandwidth - mRateBits;
+  int32_t correction = (shift < 32) ? (error >> shift) : (error < 0 ? -1 : 0);
+  mFollower.setRate(rate - correction);
   return true;
 }
 
+/**
+ * ============================================================================
+ * RatioClock
+ * ============================================================================
+ */
+
+RatioClock::RatioClock()
+{
+  mRatioPending = false;
+  mInputRate = 0;
+  mDuty = (uint32_t)1 << 31;
+  mNextRatio.numerator = 0;
+  setRatio(1, 1);
+  mRatio = mNextRatio;
+  reset();
+}
+
+void RatioClock::scaleRate(uint32_t rate, Ratio *ratio)
+{
+  // rate * numerator / denominator, exactly, without overflowing
+  uint8_t numerator = ratio->numerator;
+  uint8_t denominator = ratio->denominator;
+  uint32_t quotient = rate / denominator;
+  uint16_t rest = (uint16_t)(rate % denominator) * numerator;
+  if (quotient > ((uint32_t)1 << 31) / numerator) {
+    // Faster than half the tick rate; edges would be lost anyway.
+    ratio->increment = (uint32_t)1 << 31;
+    ratio->incrementError = 0;
+  } else {
+    ratio->increment = quotient * numerator + rest / denominator;
+    ratio->incrementError = rest % denominator;
+  }
+}
+
+void RatioClock::setRatio(uint8_t numerator, uint8_t denominator)
+{
+  numerator = constrain(numerator, 1, 255);
+  denominator = constrain(denominator, 1, 255);
+  if (numerator == mNextRatio.numerator &&
+      denominator == mNextRatio.denominator)
+    return;
+
+  // numerator / denominator = wraps + remainder / denominator, and
+  // remainder * 2^32 / denominator = phase + error / denominator,
+  // by long division 16 bits at a time.
+  Ratio ratio;
+  ratio.numerator = numerator;
+  ratio.denominator = denominator;
+  ratio.wraps = numerator / denominator;
+  uint32_t rest = (uint32_t)(numerator % denominator) << 16;
+  uint32_t high = rest / denominator;
+  rest = (rest % denominator) << 16;
+  ratio.phase = (high << 16) | (rest / denominator);
+  ratio.error = rest % denominator;
+  scaleRate(mInputRate, &ratio);
+
+  noInterrupts();
+  mNextRatio = ratio;
+  mRatioPending = true;
+  interrupts();
+}
+
+void RatioClock::setInputRate(uint32_t rate)
+{
+  if (rate == mInputRate)
+    return;
+  mInputRate = rate;
+
+  // Both the current ratio and any ratio waiting for the next frame need
+  // their increments at the new rate. tick() may switch ratios in between,
+  // so match them back up by value.
+  noInterrupts();
+  Ratio current = mRatio;
+  interrupts();
+  Ratio next = mNextRatio;
+  scaleRate(rate, &current);
+  scaleRate(rate, &next);
+
+  noInterrupts();
+  if (mRatio.numerator == current.numerator &&
+      mRatio.denominator == current.denominator) {
+    mRatio.increment = current.increment;
+    mRatio.incrementError = current.incrementError;
+  } else {
+    mRatio.increment = next.increment;
+    mRatio.incrementError = next.incrementError;
+  }
+  mNextRatio.increment = next.increment;
+  mNextRatio.incrementError = next.incrementError;
+  interrupts();
+}
+
+void RatioClock::setDuty(uint32_t duty)
+{
+  noInterrupts();
+  mDuty = duty;
+  interrupts();
+}
+
+void RatioClock::reset()
+{
+  // Low, and one step short of the start of a frame.
+  mPhase = UINT32_MAX;
+  mError = 0;
+  mHoldPhase = UINT32_MAX;
+  mWrapsLeft = 0;
+  mNextError = 0;
+  mFrameEdgesLeft = 0;
+  mRising = false;
+  mFalling = false;
+  mFrameStart = false;
+}
+
+uint32_t RatioClock::getPhase() const
+{
+  return mPhase;
+}
+
+uint32_t RatioClock::getDuty() const
+{
+  return mDuty;
+}
+
+bool RatioClock::getState() const
+{
+  return mPhase < mDuty;
+}
+
+bool RatioClock::isRising() const
+{
+  return mRising;
+}
+
+bool RatioClock::isFalling() const
+{
+  return mFalling;
+}
+
+bool RatioClock::isStartOfFrame() const
+{
+  return mFrameStart;
+}
+
+uint8_t RatioClock::getNumerator() const
+{
+  return mRatio.numerator;
+}
+
+void RatioClock::moveTo(uint32_t phase, uint8_t wraps)
+{
+  // Same as FastClock: the output rises every time it wraps around (unless
+  // the duty is 0), and falls whenever the duty is somewhere in between.
+  uint32_t duty = mDuty;
+  uint32_t prevPhase = mPhase;
+  mRising = wraps && duty;
+  if (!duty)
+    mFalling = false;
+  else if (wraps > 1)
+    mFalling = true;
+  else if (wraps == 1)
+    mFalling = prevPhase < duty || phase >= duty;
+  else
+    mFalling = prevPhase < duty && phase >= duty;
+  mPhase = phase;
+}
+
+void RatioClock::tick(bool inputRising)
+{
+  uint8_t denominator = mRatio.denominator;
+  mFrameStart = false;
+
+  if (inputRising) {
+    // Jump to where the output should be at this edge, catching up on
+    // any wraps it hasn't made yet.
+    uint32_t phase = mHoldPhase + 1;
+    uint8_t wraps = mWrapsLeft + (phase == 0);
+    uint16_t error = mNextError;
+
+    if (mFrameEdgesLeft == 0) {
+      // A new frame. The output should be back at 0 already; this also
+      // lines it back up after reset() or a new ratio.
+      if (mRatioPending) {
+        mRatio = mNextRatio;
+        mRatioPending = false;
+        denominator = mRatio.denominator;
+      }
+      mFrameEdgesLeft = denominator;
+      mFrameStart = true;
+      phase = 0;
+      error = 0;
+    }
+    --mFrameEdgesLeft;
+
+    moveTo(phase, wraps);
+    mError = error;
+
+    // Work out where the output will be at the next edge.
+    uint32_t next = phase + mRatio.phase;
+    uint8_t nextWraps = mRatio.wraps + (next < phase);
+    error += mRatio.error;
+    if (error >= denominator) {
+      error -= denominator;
+      if (++next == 0)
+        ++nextWraps;
+    }
+    mHoldPhase = next - 1;
+    mWrapsLeft = nextWraps - (next == 0);
+    mNextError = error;
+    return;
+  }
+
+  uint32_t phase = mPhase + mRatio.increment;
+  uint16_t error = mError + mRatio.incrementError;
+  if (error >= denominator) {
+    error -= denominator;
+    ++phase;
+  }
+  bool wrapped = phase < mPhase;
+
+  bool overshot = false;
+  if (wrapped) {
+    if (mWrapsLeft)
+      --mWrapsLeft;
+    else
+      overshot = true;
+  }
+  if (overshot || (!mWrapsLeft && phase > mHoldPhase)) {
+    // Wait here for the input edge.
+    phase = mHoldPhase;
+    error = 0;
+    wrapped = wrapped && !overshot;
+  }
+
+  moveTo(phase, wrapped);
+  mError = error;
+}
+
 }  //JNTUB
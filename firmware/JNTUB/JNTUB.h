@@ -193,10 +193,83 @@ namespace JNTUB {
   };
   void setUpTimerInterrupt(SampleRate rate);  // call once during setup()
 
+  // Timer/Counter0 prescaler setUpTimerInterrupt() uses for a sample rate:
+  // the smallest one (1, 8, 64, 256 or 1024) that lets the timer count out
+  // a whole sample period in 8 bits.
+  constexpr uint16_t timerPrescaler(SampleRate rate, uint16_t prescaler=1)
+  {
+    return (F_CPU / prescaler / rate <= 256 || prescaler == 1024) ?
+      prescaler :
+      timerPrescaler(rate, (prescaler == 1) ? 8 :
+                           (prescaler == 8) ? 64 :
+                           prescaler * 4);
+  }
+
+  // Prescaled timer ticks per sample, rounded down.
+  constexpr uint16_t timerPeriod(SampleRate rate)
+  {
+    return F_CPU / timerPrescaler(rate) / rate;
+  }
+
+  // CPU cycles per sample. F_CPU doesn't always divide evenly into the
+  // nominal rate (e.g. 4 kHz at 16 MHz is really 4032 Hz), so anything that
+  // depends on the exact sample rate (like pitch tables) should use
+  // F_CPU / cyclesPerSample() rather than the SampleRate value itself.
+  constexpr uint32_t cyclesPerSample(SampleRate rate)
+  {
+    return (uint32_t)timerPrescaler(rate) * timerPeriod(rate);
+  }
+
+  // Sample rate actually achieved, in Hz.
+  constexpr float actualSampleRate(SampleRate rate)
+  {
+    return (float)F_CPU / cyclesPerSample(rate);
+  }
+
   // Implement ISR(TIMER_INTERRUPT) {} for the timer/audio service routine.
   // Call JNTUB::analagWriteOut() to output an audio sample.
   #define TIMER_INTERRUPT TIMER0_COMPA_vect
 
+  /**
+   * =======================================================================
+   * GATE EDGE TIMING
+   * =======================================================================
+   *
+   * Sampling GATE/TRG in the timer interrupt only places its edges to the
+   * nearest timer tick (125 us at 8 kHz). For finer timing, enable the
+   * pin change interrupt on GATE/TRG and timestamp each edge with Timer/
+   * Counter0's count, which runs from 0 to TOP once per tick:
+   *
+   *    JNTUB::EdgeTimer edgeTimer;
+   *
+   *    setup():
+   *      JNTUB::setUpTimerInterrupt(rate);
+   *      JNTUB::setUpGateInterrupt();
+   *      edgeTimer.begin();
+   *
+   *    ISR(GATE_INTERRUPT) {
+   *      edgeTimer.capture();
+   *    }
+   *
+   *    ISR(TIMER_INTERRUPT) {
+   *      uint8_t elapsed = edgeTimer.elapsed();
+   *      bool gate = digitalRead(JNTUB::PIN_GATE_TRG);
+   *      approximator.tick(gate, elapsed);
+   *    }
+   *
+   * elapsed() is how long ago (as UQ0.8, in fractions of a tick) the last
+   * edge happened, as of the timer interrupt that sees it. Take it before
+   * reading the gate, so an edge that lands in between counts as 0 elapsed
+   * rather than being missed. elapsed() compares the edge's count with the
+   * current one, so an edge that lands after the compare match but before
+   * elapsed() (say, while the PWM interrupt is nested in this one) also
+   * counts as 0 rather than as a whole tick ago.
+   */
+  void setUpGateInterrupt();  // call once during setup()
+
+  // Implement ISR(GATE_INTERRUPT) {} and call EdgeTimer::capture() from it.
+  #define GATE_INTERRUPT PCINT0_vect
+
   /*
    * =======================================================================
    * UTILITY FUNCTIONS
@@ -205,12 +278,934 @@ namespace JNTUB {
 
   #define absdiff(a, b) ((a < b) ? (b - a) : (a - b))
 
+  /*
+   * =======================================================================
+   * FIXED-POINT ARITHMETIC
+   * =======================================================================
+   *
+   * The ATtiny85 has no FPU and no hardware multiplier, so pretty much every
+   * module does its math in fixed point: phases get sliced out of clock
+   * accumulators, and blend factors are expressed out of 32 or 128.
+   *
+   * Fixed<T, FracBits> is an integer of type T whose lowest FracBits bits
+   * are fractional. The typedefs use Q notation, where the integer part
+   * counts the sign bit:
+   *
+   *    Q1_7    - signed 8-bit, range [-1, 1)
+   *    UQ0_8   - unsigned 8-bit, range [0, 1)
+   *    Q8_8    - signed 16-bit, range [-128, 128)
+   *    Q1_15   - signed 16-bit, range [-1, 1)
+   *    UQ8_8   - unsigned 16-bit, range [0, 256)
+   *    UQ0_16  - unsigned 16-bit, range [0, 1)
+   *    UQ16_16 - unsigned 32-bit, range [0, 65536)
+   *
+   * For the really hot paths (interpolating wavetables, blending curves),
+   * use the free functions fracMultiply(), lerp() and lerpExtended() on raw
+   * integers. Multiplying by a fraction with only a handful of bits is much
+   * cheaper as an unrolled sequence of shifts and adds than as a call to
+   * the compiler's software multiply routine, so that's what they do on
+   * MCUs without a MUL instruction.
+   */
+
+  template<typename T> struct FixedTraits {};
+
+  template<> struct FixedTraits<int8_t> {
+    typedef int16_t Wide;      // holds the product of two values
+    typedef int16_t Diff;      // holds the difference of two values
+    typedef uint8_t Unsigned;
+    static const bool IS_SIGNED = true;
+    static const int8_t MIN_VALUE = INT8_MIN;
+    static const int8_t MAX_VALUE = INT8_MAX;
+  };
+
+  template<> struct FixedTraits<uint8_t> {
+    typedef uint16_t Wide;
+    typedef int16_t Diff;
+    typedef uint8_t Unsigned;
+    static const bool IS_SIGNED = false;
+    static const uint8_t MIN_VALUE = 0;
+    static const uint8_t MAX_VALUE = UINT8_MAX;
+  };
+
+  template<> struct FixedTraits<int16_t> {
+    typedef int32_t Wide;
+    typedef int32_t Diff;
+    typedef uint16_t Unsigned;
+    static const bool IS_SIGNED = true;
+    static const int16_t MIN_VALUE = INT16_MIN;
+    static const int16_t MAX_VALUE = INT16_MAX;
+  };
+
+  template<> struct FixedTraits<uint16_t> {
+    typedef uint32_t Wide;
+    typedef int32_t Diff;
+    typedef uint16_t Unsigned;
+    static const bool IS_SIGNED = false;
+    static const uint16_t MIN_VALUE = 0;
+    static const uint16_t MAX_VALUE = UINT16_MAX;
+  };
+
+  template<> struct FixedTraits<int32_t> {
+    typedef int64_t Wide;
+    typedef int32_t Diff;      // caller must keep differences in range
+    typedef uint32_t Unsigned;
+    static const bool IS_SIGNED = true;
+    static const int32_t MIN_VALUE = INT32_MIN;
+    static const int32_t MAX_VALUE = INT32_MAX;
+  };
+
+  template<> struct FixedTraits<uint32_t> {
+    typedef uint64_t Wide;
+    typedef int32_t Diff;      // caller must keep differences in range
+    typedef uint32_t Unsigned;
+    static const bool IS_SIGNED = false;
+    static const uint32_t MIN_VALUE = 0;
+    static const uint32_t MAX_VALUE = UINT32_MAX;
+  };
+
+  // a + b, clamped to the range of T instead of wrapping around.
+  template<typename T>
+  inline T addSaturating(T a, T b)
+  {
+    typedef FixedTraits<T> Traits;
+    T sum = (T)((typename Traits::Unsigned)a + (typename Traits::Unsigned)b);
+    if (Traits::IS_SIGNED) {
+      // Overflow iff a and b have the same sign and sum has the other one.
+      if ((T)((a ^ sum) & (b ^ sum)) < 0)
+        sum = (a < 0) ? Traits::MIN_VALUE : Traits::MAX_VALUE;
+    } else if (sum < a) {
+      sum = Traits::MAX_VALUE;
+    }
+    return sum;
+  }
+
+  // a - b, clamped to the range of T instead of wrapping around.
+  template<typename T>
+  inline T subSaturating(T a, T b)
+  {
+    typedef FixedTraits<T> Traits;
+    T diff = (T)((typename Traits::Unsigned)a - (typename Traits::Unsigned)b);
+    if (Traits::IS_SIGNED) {
+      // Overflow iff a and b have different signs and diff's sign isn't a's.
+      if ((T)((a ^ b) & (a ^ diff)) < 0)
+        diff = (a < 0) ? Traits::MIN_VALUE : Traits::MAX_VALUE;
+    } else if (b > a) {
+      diff = Traits::MIN_VALUE;
+    }
+    return diff;
+  }
+
+  // One step of fracMultiply(), unrolled at compile time.
+  // Horner's method from the least significant bit of frac: each step adds
+  // value if the bit is set and then halves the running total.
+  template<uint8_t Bit, uint8_t Bits>
+  struct FracMultiplyStep {
+    template<typename V>
+    static inline V apply(V acc, V value, uint16_t frac)
+    {
+      if (frac & (1U << Bit))
+        acc += value;
+      return FracMultiplyStep<Bit+1, Bits>::apply((V)(acc >> 1), value, frac);
+    }
+  };
+
+  template<uint8_t Bits>
+  struct FracMultiplyStep<Bits, Bits> {
+    template<typename V>
+    static inline V apply(V acc, V value, uint16_t frac)
+    {
+      // Only set when frac == 2^Bits
+      if (frac & (1U << Bits))
+        acc += value;
+      return acc;
+    }
+  };
+
+  // One step of smallMultiply(), unrolled at compile time.
+  // Horner's method from the most significant bit of m.
+  template<int8_t Bit>
+  struct SmallMultiplyStep {
+    template<typename V>
+    static inline V apply(V acc, V value, uint16_t m)
+    {
+      acc += acc;
+      if (m & (1U << Bit))
+        acc += value;
+      return SmallMultiplyStep<Bit-1>::apply(acc, value, m);
+    }
+  };
+
+  template<>
+  struct SmallMultiplyStep<-1> {
+    template<typename V>
+    static inline V apply(V acc, V, uint16_t)
+    {
+      return acc;
+    }
+  };
+
+  /**
+   * Returns floor(value * frac / 2^Bits), for 0 <= frac <= 2^Bits.
+   *
+   * The result is exact (no accumulated rounding error), but V needs one bit
+   * of headroom above the magnitude of value.
+   */
+  template<uint8_t Bits, typename V>
+  inline V fracMultiply(V value, uint16_t frac)
+  {
+    static_assert(Bits < 16, "fraction must fit in 16 bits");
+#if defined(__AVR_HAVE_MUL__)
+    return ((typename FixedTraits<V>::Wide)value * frac) >> Bits;
+#else
+    return FracMultiplyStep<0, Bits>::apply((V)0, value, frac);
+#endif
+  }
+
+  /**
+   * Returns value * m, for 0 <= m <= 2^Bits.
+   */
+  template<uint8_t Bits, typename V>
+  inline V smallMultiply(V value, uint16_t m)
+  {
+    static_assert(Bits < 16, "multiplier must fit in 16 bits");
+#if defined(__AVR_HAVE_MUL__)
+    return value * m;
+#else
+    return SmallMultiplyStep<Bits>::apply((V)0, value, m);
+#endif
+  }
+
+  // High byte of a * b (i.e., a * b / 256, rounded down).
+  inline uint8_t mulHigh(uint8_t a, uint8_t b)
+  {
+    return fracMultiply<8>((uint16_t)a, b);
+  }
+
+  /**
+   * Linear interpolation with no divides and no multiplies.
+   *
+   *    For frac = 0, returns a
+   *    For frac = 2^(FracBits-1), returns the average of a and b
+   *    For frac = 2^FracBits, returns b
+   *
+   * Rounds toward negative infinity.
+   */
+  template<uint8_t FracBits, typename T>
+  inline T lerp(T a, T b, uint16_t frac)
+  {
+    typedef typename FixedTraits<T>::Diff D;
+    return a + (T)fracMultiply<FracBits>((D)((D)b - (D)a), frac);
+  }
+
+  /**
+   * Linear interpolation that keeps the FracBits of extra precision that
+   * lerp() throws away. Returns a * 2^FracBits + (b - a) * frac.
+   *
+   * Handy for filling a higher-resolution output (like 10-bit PWM) from
+   * 8-bit table values.
+   */
+  template<uint8_t FracBits, typename T>
+  inline typename FixedTraits<T>::Diff lerpExtended(T a, T b, uint16_t frac)
+  {
+    typedef typename FixedTraits<T>::Diff D;
+    return (D)a * (1 << FracBits) +
+           smallMultiply<FracBits>((D)((D)b - (D)a), frac);
+  }
+
+  template<typename T, uint8_t FracBits>
+  class Fixed {
+  public:
+    typedef FixedTraits<T> Traits;
+    typedef typename Traits::Unsigned Unsigned;
+
+    static const uint8_t FRAC_BITS = FracBits;
+    static const Unsigned FRAC_MASK = ((typename Traits::Wide)1 << FracBits) - 1;
+
+    T mRaw;
+
+    static Fixed fromRaw(T raw)
+    {
+      Fixed f;
+      f.mRaw = raw;
+      return f;
+    }
+
+    static Fixed fromInt(T value)
+    {
+      return fromRaw((T)(value * ((typename Traits::Wide)1 << FracBits)));
+    }
+
+    T raw() const
+    {
+      return mRaw;
+    }
+
+    // Integer part, rounded toward negative infinity.
+    T toInt() const
+    {
+      return mRaw >> FracBits;
+    }
+
+    // Fractional part, as an unsigned FracBits-bit number.
+    Unsigned fraction() const
+    {
+      return (Unsigned)mRaw & FRAC_MASK;
+    }
+
+    // Wrapping arithmetic, same as the underlying integers.
+    Fixed operator+(Fixed other) const
+    {
+      return fromRaw(mRaw + other.mRaw);
+    }
+    Fixed operator-(Fixed other) const
+    {
+      return fromRaw(mRaw - other.mRaw);
+    }
+
+    Fixed addSaturating(Fixed other) const
+    {
+      return fromRaw(JNTUB::addSaturating(mRaw, other.mRaw));
+    }
+    Fixed subSaturating(Fixed other) const
+    {
+      return fromRaw(JNTUB::subSaturating(mRaw, other.mRaw));
+    }
+
+    // **SLOW** on MCUs without MUL (full-width software multiply).
+    // For small fractional multiplicands, prefer scale().
+    Fixed mulHigh(Fixed other) const
+    {
+      typedef typename Traits::Wide W;
+      return fromRaw((T)(((W)mRaw * other.mRaw) >> FracBits));
+    }
+
+    // Multiply by a fraction frac / 2^Bits (0 <= frac <= 2^Bits) using
+    // shifts and adds. Needs one bit of headroom in T.
+    template<uint8_t Bits>
+    Fixed scale(uint16_t frac) const
+    {
+      return fromRaw(fracMultiply<Bits>(mRaw, frac));
+    }
+
+    bool operator==(Fixed other) const { return mRaw == other.mRaw; }
+    bool operator!=(Fixed other) const { return mRaw != other.mRaw; }
+    bool operator<(Fixed other) const { return mRaw < other.mRaw; }
+    bool operator>(Fixed other) const { return mRaw > other.mRaw; }
+    bool operator<=(Fixed other) const { return mRaw <= other.mRaw; }
+    bool operator>=(Fixed other) const { return mRaw >= other.mRaw; }
+  };
+
+  typedef Fixed<int8_t, 7>     Q1_7;
+  typedef Fixed<uint8_t, 8>    UQ0_8;
+  typedef Fixed<int16_t, 8>    Q8_8;
+  typedef Fixed<int16_t, 15>   Q1_15;
+  typedef Fixed<uint16_t, 8>   UQ8_8;
+  typedef Fixed<uint16_t, 16>  UQ0_16;
+  typedef Fixed<uint32_t, 16>  UQ16_16;
+
+  /*
+   * =======================================================================
+   * PROGRAM MEMORY TABLES
+   * =======================================================================
+   *
+   * Wavetables and curves live in flash (PROGMEM), since SRAM is tiny.
+   * ProgmemTable wraps a pointer to one of those tables and takes care of
+   * splitting a phase into a table index and an interpolation fraction.
+   */
+
+  // Log2<N>::VALUE = floor(log2(N)), at compile time.
+  template<unsigned N>
+  struct Log2 {
+    static const uint8_t VALUE = 1 + Log2<N / 2>::VALUE;
+  };
+
+  template<>
+  struct Log2<1> {
+    static const uint8_t VALUE = 0;
+  };
+
+  // Reads an integer of any width from program memory.
+  template<uint8_t Size> struct PgmReader {};
+
+  template<> struct PgmReader<1> {
+    static inline uint8_t read(const void *p) { return pgm_read_byte_near(p); }
+  };
+  template<> struct PgmReader<2> {
+    static inline uint16_t read(const void *p) { return pgm_read_word_near(p); }
+  };
+  template<> struct PgmReader<4> {
+    static inline uint32_t read(const void *p) { return pgm_read_dword_near(p); }
+  };
+
+  template<typename T>
+  inline T pgmRead(const T *p)
+  {
+    return (T)PgmReader<sizeof(T)>::read(p);
+  }
+
+  // Reads p[0] and p[1] from program memory.
+  template<typename T>
+  inline void pgmReadPair(const T *p, T &a, T &b)
+  {
+    a = pgmRead(p);
+    b = pgmRead(p + 1);
+  }
+
+#if defined(__AVR__)
+  // Byte pairs are read with back-to-back LPM Z+ instructions, rather than
+  // loading the Z register twice.
+  inline void pgmReadPair(const uint8_t *p, uint8_t &a, uint8_t &b)
+  {
+    asm volatile(
+      "lpm %0, Z+" "\n\t"
+      "lpm %1, Z+" "\n\t"
+      : "=&r" (a), "=&r" (b), "+z" (p)
+    );
+  }
+
+  inline void pgmReadPair(const int8_t *p, int8_t &a, int8_t &b)
+  {
+    pgmReadPair((const uint8_t *)p, (uint8_t &)a, (uint8_t &)b);
+  }
+#endif
+
+  /**
+   * Storage policies, for classes that can keep their data in either SRAM or
+   * program memory. read() returns element i of an array stored that way.
+   */
+  struct RamStorage {
+    template<typename T>
+    static inline T read(const T *array, uint8_t i)
+    {
+      return array[i];
+    }
+  };
+
+  struct ProgmemStorage {
+    template<typename T>
+    static inline T read(const T *array, uint8_t i)
+    {
+      return pgmRead(array + i);
+    }
+  };
+
+  enum TableMode {
+    TABLE_WRAP,   // cyclic (wavetables): reading past the end wraps around
+    TABLE_CLAMP,  // one-shot (curves): reading past the end repeats the end
+  };
+
+  /**
+   * How much of a table is actually stored. Symmetric waves only need part
+   * of their period stored; the rest is rebuilt from symmetry on each read,
+   * which costs a few cycles but can save most of the table's flash.
+   *
+   * "Negating" a value here means flipping all of its bits (~v), so that
+   * a signed table still spans the full [-128, 127] range.
+   */
+  enum TableStorage {
+    // All N entries are stored.
+    TABLE_FULL,
+    // N/2 entries are stored. The second half of the table is the first half
+    // negated (like a square wave, or a sine).
+    TABLE_HALF_WAVE,
+    // N/4 + 1 entries are stored: the first quarter, up to and including the
+    // peak at N/4. The second quarter is the first one mirrored, and the
+    // second half is the first half negated (like a sine or a triangle).
+    TABLE_QUARTER_WAVE,
+  };
+
+  /**
+   * A table of N values of type T stored in program memory. N must be a
+   * power of two.
+   *
+   * Reads take a phase of any width: the top log2(N) of its PhaseBits bits
+   * select the table entry, and the bits below that are the fraction used
+   * for interpolating to the next entry. Only the top FracBits of those are
+   * used (defaults to all of them).
+   *
+   * In TABLE_WRAP mode, the entry after N-1 is entry 0 and bits of the phase
+   * above PhaseBits are ignored. In TABLE_CLAMP mode, the entry after N-1
+   * is N-1 again, so the last segment is flat.
+   *
+   * Storage says how many of the N entries the table in program memory
+   * actually holds (see TableStorage).
+   */
+  template<typename T, unsigned N, TableMode Mode=TABLE_WRAP,
+           TableStorage Storage=TABLE_FULL>
+  class ProgmemTable {
+  private:
+    static_assert((N & (N - 1)) == 0, "table size must be a power of two");
+    static_assert(Storage == TABLE_FULL || N >= 4,
+                  "symmetric tables need at least 4 entries");
+
+    static const uint16_t HALF = N / 2;
+    static const uint16_t QUARTER = N / 4;
+
+  public:
+    static const uint8_t INDEX_BITS = Log2<N>::VALUE;
+    static const uint16_t INDEX_MASK = N - 1;
+
+    typedef typename FixedTraits<T>::Diff Diff;
+
+    const T *mTable;
+
+    ProgmemTable(const T *table=nullptr) : mTable(table) {}
+
+    void setTable(const T *table)
+    {
+      mTable = table;
+    }
+
+    // Number of entries actually stored in program memory.
+    static const uint16_t STORED_SIZE =
+      (Storage == TABLE_QUARTER_WAVE) ? QUARTER + 1 :
+      (Storage == TABLE_HALF_WAVE) ? HALF :
+      N;
+
+    // Entry at index (0 to N-1).
+    inline T read(uint16_t index) const
+    {
+      if (Storage == TABLE_FULL)
+        return pgmRead(mTable + index);
+
+      uint16_t stored = index & (HALF - 1);
+      if (Storage == TABLE_QUARTER_WAVE && stored > QUARTER)
+        stored = HALF - stored;
+      T value = pgmRead(mTable + stored);
+      return (index & HALF) ? (T)~value : value;
+    }
+
+    // Entry at any index, wrapped or clamped according to Mode.
+    inline T readAt(int16_t index) const
+    {
+      if (Mode == TABLE_WRAP)
+        return read(index & INDEX_MASK);
+      if (index < 0)
+        return read(0);
+      if (index > (int16_t)INDEX_MASK)
+        return read(INDEX_MASK);
+      return read(index);
+    }
+
+    template<uint8_t PhaseBits, typename P>
+    static inline uint16_t indexOf(P phase)
+    {
+      static_assert(PhaseBits >= INDEX_BITS, "phase narrower than table");
+      return (uint16_t)(phase >> (PhaseBits - INDEX_BITS)) & INDEX_MASK;
+    }
+
+    template<uint8_t PhaseBits, uint8_t FracBits, typename P>
+    static inline uint16_t fractionOf(P phase)
+    {
+      static_assert(PhaseBits >= INDEX_BITS + FracBits,
+                    "not enough phase bits for fraction");
+      return (uint16_t)(phase >> (PhaseBits - INDEX_BITS - FracBits)) &
+             ((1U << FracBits) - 1);
+    }
+
+    // Entries at index and the one after it.
+    inline void readSegment(uint16_t index, T &a, T &b) const
+    {
+      if (Storage != TABLE_FULL) {
+        a = read(index);
+        b = readAt(index + 1);
+      } else if (index < INDEX_MASK) {
+        pgmReadPair(mTable + index, a, b);
+      } else {
+        a = read(index);
+        b = (Mode == TABLE_WRAP) ? read(0) : a;
+      }
+    }
+
+    // No interpolation; the entry the phase falls in.
+    template<uint8_t PhaseBits, typename P>
+    inline T nearest(P phase) const
+    {
+      return read(indexOf<PhaseBits>(phase));
+    }
+
+    // Linear interpolation between the two entries the phase falls between.
+    template<uint8_t PhaseBits, uint8_t FracBits=PhaseBits-INDEX_BITS,
+             typename P>
+    inline T linear(P phase) const
+    {
+      T a, b;
+      readSegment(indexOf<PhaseBits>(phase), a, b);
+      return lerp<FracBits>(a, b, fractionOf<PhaseBits, FracBits>(phase));
+    }
+
+    // Same as linear(), but keeps FracBits of extra output precision.
+    // See lerpExtended().
+    template<uint8_t PhaseBits, uint8_t FracBits=PhaseBits-INDEX_BITS,
+             typename P>
+    inline Diff linearExtended(P phase) const
+    {
+      T a, b;
+      readSegment(indexOf<PhaseBits>(phase), a, b);
+      return lerpExtended<FracBits>(
+        a, b, fractionOf<PhaseBits, FracBits>(phase));
+    }
+
+    // Catmull-Rom cubic interpolation through the four surrounding entries.
+    // Smoother than linear() but may overshoot, so the result saturates.
+    // **SLOW** (software multiplies on the ATtiny85). Not for ISRs.
+    template<uint8_t PhaseBits, uint8_t FracBits=PhaseBits-INDEX_BITS,
+             typename P>
+    T cubic(P phase) const
+    {
+      static_assert(FracBits <= 8, "cubic() fraction must fit in 8 bits");
+      typedef int32_t W;
+      int16_t index = indexOf<PhaseBits>(phase);
+      W t = fractionOf<PhaseBits, FracBits>(phase);
+      W p0 = readAt(index - 1);
+      W p1 = readAt(index);
+      W p2 = readAt(index + 1);
+      W p3 = readAt(index + 2);
+
+      W r = 3 * (p1 - p2) + p3 - p0;
+      r = ((r * t) >> FracBits) + 2 * p0 - 5 * p1 + 4 * p2 - p3;
+      r = ((r * t) >> FracBits) + p2 - p0;
+      r = ((r * t) >> (FracBits + 1)) + p1;
+
+      if (r > FixedTraits<T>::MAX_VALUE)
+        return FixedTraits<T>::MAX_VALUE;
+      if (r < FixedTraits<T>::MIN_VALUE)
+        return FixedTraits<T>::MIN_VALUE;
+      return r;
+    }
+  };
+
+  /*
+   * Waveforms simple enough to compute directly from the phase, so they need
+   * no table at all. Each one takes the top Bits bits of a PhaseBits-bit
+   * phase and returns a signed Bits-bit sample, in [-2^(Bits-1), 2^(Bits-1)).
+   * The phase is wrapped, same as a TABLE_WRAP table.
+   *
+   * So a 10-bit sample from a 10-bit phase is (within a few LSBs) what
+   * linearExtended<10>() gives for the same wave stored in a 256-entry table,
+   * e.g. for 10-bit PWM output.
+   */
+
+  template<uint8_t Bits, uint8_t PhaseBits, typename P>
+  inline uint16_t wavePhase(P phase)
+  {
+    static_assert(Bits <= 16 && Bits <= PhaseBits, "bad waveform bit width");
+    return (uint16_t)(phase >> (PhaseBits - Bits)) &
+           (uint16_t)((1UL << Bits) - 1);
+  }
+
+  // Rises from the minimum to the maximum over the period.
+  template<uint8_t Bits, uint8_t PhaseBits=Bits, typename P>
+  inline int16_t rampWave(P phase)
+  {
+    const uint16_t half = 1U << (Bits - 1);
+    return (int16_t)(wavePhase<Bits, PhaseBits>(phase) - half);
+  }
+
+  // Falls from the maximum to the minimum over the period.
+  template<uint8_t Bits, uint8_t PhaseBits=Bits, typename P>
+  inline int16_t sawWave(P phase)
+  {
+    const uint16_t half = 1U << (Bits - 1);
+    return (int16_t)(half - 1 - wavePhase<Bits, PhaseBits>(phase));
+  }
+
+  // Maximum for the first half of the period, minimum for the second half.
+  template<uint8_t Bits, uint8_t PhaseBits=Bits, typename P>
+  inline int16_t squareWave(P phase)
+  {
+    const uint16_t half = 1U << (Bits - 1);
+    return (wavePhase<Bits, PhaseBits>(phase) < half) ?
+      (int16_t)(half - 1) : (int16_t)(0 - half);
+  }
+
+  // Starts (just above) zero, peaks a quarter of the way through and
+  // troughs three quarters of the way through. Same phase as a sine.
+  template<uint8_t Bits, uint8_t PhaseBits=Bits, typename P>
+  inline int16_t triangleWave(P phase)
+  {
+    const uint16_t half = 1U << (Bits - 1);
+    const uint16_t mask = (uint16_t)((1UL << Bits) - 1);
+    // Shift by a quarter period so the fold lands on the peak.
+    uint16_t s = (wavePhase<Bits, PhaseBits>(phase) + (half >> 1)) & mask;
+    if (s >= half)
+      s = mask - s;
+    // s rises 0 to half-1 then falls back; stretch it over the full range.
+    return (int16_t)((s << 1) + 1 - half);
+  }
+
+  /*
+   * Tables generated at compile time, so they always match the sample rate,
+   * clock frequency and table size they're built for, rather than whatever
+   * they were when someone last ran a script and pasted its output in.
+   *
+   * A generator is a struct with a Type typedef and a
+   * static constexpr Type value(unsigned i) function (C++11 constexpr
+   * functions are a single return statement, hence all the recursion).
+   * GeneratedTable<Generator, N>::DATA is then a PROGMEM array of value(0)
+   * through value(N-1), ready to hand to ProgmemTable.
+   *
+   * The math helpers below use float on purpose: it's what double is on AVR
+   * anyway, so tables come out the same when checked on a desktop compiler.
+   */
+
+  constexpr float PI_F = 3.14159265f;
+  constexpr float LN2_F = 0.693147181f;
+
+  constexpr float constSinSeries(float x2, float term, uint8_t n)
+  {
+    return (n > 12) ? term :
+      term + constSinSeries(x2, -term * x2 / ((2 * n) * (2 * n + 1)), n + 1);
+  }
+
+  // sin(x), for -2pi <= x <= 2pi.
+  constexpr float constSin(float x)
+  {
+    return (x > PI_F) ? -constSin(x - PI_F) :
+           (x < -PI_F) ? -constSin(x + PI_F) :
+           constSinSeries(x * x, x, 1);
+  }
+
+  constexpr float constExpSeries(float x, float term, uint8_t n)
+  {
+    return (n > 30) ? term : term + constExpSeries(x, term * x / n, n + 1);
+  }
+
+  // e^x, for moderate x (the series needs more terms past about |x| = 8).
+  constexpr float constExp(float x)
+  {
+    return (x < 0) ? 1 / constExpSeries(-x, 1, 1) : constExpSeries(x, 1, 1);
+  }
+
+  // Round to nearest, for non-negative x.
+  constexpr uint32_t constRound(float x)
+  {
+    return (uint32_t)(x + 0.5f);
+  }
+
+  // floor(x), for x within the range of int32_t.
+  constexpr int32_t constFloor(float x)
+  {
+    return ((float)(int32_t)x > x) ? (int32_t)x - 1 : (int32_t)x;
+  }
+
+  template<unsigned... I> struct IndexList {};
+
+  // MakeIndexList<N>::Type is IndexList<0, 1, ..., N-1>.
+  template<unsigned N, unsigned... I>
+  struct MakeIndexList : MakeIndexList<N - 1, N - 1, I...> {};
+
+  template<unsigned... I>
+  struct MakeIndexList<0, I...> {
+    typedef IndexList<I...> Type;
+  };
+
+  template<typename Generator, unsigned N,
+           typename Indices = typename MakeIndexList<N>::Type>
+  struct GeneratedTable;
+
+  template<typename Generator, unsigned N, unsigned... I>
+  struct GeneratedTable<Generator, N, IndexList<I...>> {
+    typedef typename Generator::Type Type;
+    static const Type DATA[N];
+  };
+
+  template<typename Generator, unsigned N, unsigned... I>
+  const typename Generator::Type
+  GeneratedTable<Generator, N, IndexList<I...>>::DATA[N] PROGMEM = {
+    Generator::value(I)...
+  };
+
+  /**
+   * One period of a sine wave over Period entries, at the full range of T
+   * (rounded, so entry Period/4 is exactly the maximum of T).
+   *
+   * For a TABLE_QUARTER_WAVE table, generate only the first Period/4 + 1
+   * entries: GeneratedTable<SineWave<int8_t, 256>, 65>.
+   */
+  template<typename T, unsigned Period>
+  struct SineWave {
+    typedef T Type;
+
+    static constexpr T value(unsigned i)
+    {
+      return (T)constFloor(
+        FixedTraits<T>::MAX_VALUE * constSin(2 * PI_F * i / Period) + 0.5f);
+    }
+  };
+
+  /**
+   * Phase increment per sample that makes a 16-bit phase accumulator
+   * (wrapping at 65536) run at the frequency of MIDI note i, at the sample
+   * rate Rate actually runs at for this F_CPU. Rounded to the nearest step.
+   *
+   * At low notes, 16 bits of phase can't get very close (up to ~25 cents
+   * off in the lowest octave at 20 kHz).
+   */
+  template<SampleRate Rate>
+  struct MidiNotePitch {
+    typedef uint16_t Type;
+
+    static constexpr float frequency(unsigned note)
+    {
+      return 440.0f * constExp(((float)note - 69) * LN2_F / 12);
+    }
+
+    static constexpr uint16_t value(unsigned note)
+    {
+      return (frequency(note) * 65536.0f / actualSampleRate(Rate) >= 65535) ?
+        65535 :
+        constRound(frequency(note) * 65536.0f / actualSampleRate(Rate));
+    }
+  };
+
   /*
    * =======================================================================
    * UTILITY CLASSES
    * =======================================================================
    */
 
+  /**
+   * Smoothers for raw analogRead() values (0 to 1023), to put in front of a
+   * DiscreteKnob or CurveKnob:
+   *
+   *    knob.update(smoother.update(analogRead(JNTUB::PIN_PARAM1)));
+   *
+   * ADC noise otherwise shows up as zipper noise in the output, and as
+   * work redone in loop() whenever a knob flickers by a step.
+   *
+   * All of them keep SMOOTHER_FRAC_BITS fractional bits in 16-bit state and
+   * use only shifts and adds. Their time constants are in calls to update(),
+   * so they depend on how fast loop() runs.
+   */
+  static const uint8_t SMOOTHER_FRAC_BITS = 5;
+
+  // diff / 2^shift, rounded away from zero so that the state always ends up
+  // exactly on a constant input (rather than stalling a few steps short).
+  inline int16_t smootherStep(int16_t diff, uint8_t shift)
+  {
+    if (diff > 0)
+      diff += (1 << shift) - 1;
+    return diff >> shift;
+  }
+
+  /**
+   * One-pole low-pass (exponential moving average):
+   *
+   *    y += (x - y) / 2^Shift
+   *
+   * Settles in roughly 2^Shift updates.
+   */
+  template<uint8_t Shift>
+  class OnePoleSmoother {
+  private:
+    uint16_t mState;  // UQ10.5
+
+  public:
+    OnePoleSmoother() : mState(0) {}
+
+    void reset(uint16_t value)
+    {
+      mState = value << SMOOTHER_FRAC_BITS;
+    }
+
+    uint16_t update(uint16_t value)
+    {
+      int16_t diff = (int16_t)(value << SMOOTHER_FRAC_BITS) - (int16_t)mState;
+      mState += smootherStep(diff, Shift);
+      return getValue();
+    }
+
+    uint16_t getValue() const
+    {
+      return (mState + (1 << (SMOOTHER_FRAC_BITS - 1))) >> SMOOTHER_FRAC_BITS;
+    }
+  };
+
+  /**
+   * Average of the last 2^Log2Size inputs. Costs 2^(Log2Size+1) bytes of SRAM,
+   * but has no steady-state error and a hard bound on how long an old value
+   * sticks around.
+   */
+  template<uint8_t Log2Size>
+  class MovingAverageSmoother {
+  private:
+    static const uint8_t SIZE = 1 << Log2Size;
+    static_assert(Log2Size <= 5, "sum must fit in 16 bits");
+
+    uint16_t mHistory[SIZE];
+    uint16_t mSum;
+    uint8_t mIndex;
+
+  public:
+    MovingAverageSmoother()
+    {
+      reset(0);
+    }
+
+    void reset(uint16_t value)
+    {
+      for (uint8_t i = 0; i < SIZE; ++i)
+        mHistory[i] = value;
+      mSum = value << Log2Size;
+      mIndex = 0;
+    }
+
+    uint16_t update(uint16_t value)
+    {
+      mSum += value - mHistory[mIndex];
+      mHistory[mIndex] = value;
+      mIndex = (mIndex + 1) & (SIZE - 1);
+      return getValue();
+    }
+
+    uint16_t getValue() const
+    {
+      return (mSum + (SIZE >> 1)) >> Log2Size;
+    }
+  };
+
+  /**
+   * One-pole low-pass whose shift adapts to how fast the input is moving:
+   * MaxShift (heavy smoothing) while it's within a step or so of the output,
+   * one less for every doubling of the distance, down to MinShift. Holds still
+   * against noise but keeps up when the knob is turned.
+   */
+  template<uint8_t MinShift, uint8_t MaxShift>
+  class AdaptiveSmoother {
+  private:
+    static_assert(MinShift <= MaxShift, "MinShift must not exceed MaxShift");
+
+    uint16_t mState;  // UQ10.5
+
+  public:
+    AdaptiveSmoother() : mState(0) {}
+
+    void reset(uint16_t value)
+    {
+      mState = value << SMOOTHER_FRAC_BITS;
+    }
+
+    uint16_t update(uint16_t value)
+    {
+      int16_t diff = (int16_t)(value << SMOOTHER_FRAC_BITS) - (int16_t)mState;
+      uint16_t distance = (diff < 0) ? -diff : diff;
+      uint8_t shift = MaxShift;
+      for (distance >>= SMOOTHER_FRAC_BITS + 1;
+           distance && shift > MinShift;
+           distance >>= 1) {
+        --shift;
+      }
+      mState += smootherStep(diff, shift);
+      return getValue();
+    }
+
+    uint16_t getValue() const
+    {
+      return (mState + (1 << (SMOOTHER_FRAC_BITS - 1))) >> SMOOTHER_FRAC_BITS;
+    }
+  };
+
   /**
    * A knob that selects between a finite number of "categories" or "values"
    * with built-in hysteresis.
@@ -223,8 +1218,154 @@ namespace JNTUB {
    *  - The nominal cutoff from value 0 to value 1 would be 1024/4 = 128.
    *  - getValue() will not return 1 until value exceeds 138.
    *  - getValue() will not return 0 again until value goes below 118.
+   *
+   * The number of values and the hysteresis are template parameters, so the
+   * step size and the scale factors behind mapValue() and mapInnerValue() are
+   * all worked out at compile time. update() shifts rather than divides when
+   * the step is a power of two, and otherwise multiplies by the step's
+   * reciprocal. The map functions multiply by a fraction instead of going
+   * through map() (a 32-bit multiply AND divide).
+   *
+   * Use DiscreteKnob<> (see below) when these need to change at runtime.
    */
+  template<uint16_t NumValues = 0, uint8_t Hysteresis = 0>
   class DiscreteKnob {
+  public:
+    static_assert(NumValues >= 1 && NumValues <= 256,
+                  "numValues must be 1 to 256");
+
+    static const uint8_t MAX_VALUE = NumValues - 1;
+    // Width of each value's share of the input range (0 to 1023)
+    static const uint16_t STEP = 1024 / NumValues;
+
+    static_assert(Hysteresis <= STEP / 2,
+                  "hysteresis must be at most (1024 / numValues) / 2");
+
+  private:
+    // value / STEP, as a multiply by the reciprocal (rounded up). This is
+    // exact for all 10-bit inputs.
+    static const bool STEP_IS_POWER_OF_TWO = (STEP & (STEP - 1)) == 0;
+    static const uint8_t STEP_SHIFT = Log2<STEP>::VALUE;
+    static const uint8_t RECIPROCAL_SHIFT = 20;
+    static const uint32_t STEP_RECIPROCAL =
+      ((1UL << RECIPROCAL_SHIFT) + STEP - 1) / STEP;
+
+    // mapValue() fraction (UQ1.15) is value * VALUE_SCALE / 2^9.
+    // Rounding the scale up makes MAX_VALUE come out as exactly 1.0.
+    static const uint32_t VALUE_SCALE =
+      MAX_VALUE ? ((1UL << 24) + MAX_VALUE - 1) / MAX_VALUE : 0;
+
+    // Width of the input range covered by the first, last and every other
+    // value (including hysteresis), for mapInnerValue().
+    static const uint16_t FIRST_WIDTH = MAX_VALUE ? STEP + Hysteresis : 1023;
+    static const uint16_t MIDDLE_WIDTH = STEP + 2 * Hysteresis;
+    static const uint16_t LAST_WIDTH = 1023 + Hysteresis - MAX_VALUE * STEP;
+
+    // mapInnerValue() fraction (UQ1.15) is offset * scale / 2^16, where the
+    // scale is 2^31 / width, rounded up.
+    static const uint32_t FIRST_SCALE =
+      ((1UL << 31) + FIRST_WIDTH - 1) / FIRST_WIDTH;
+    static const uint32_t MIDDLE_SCALE =
+      ((1UL << 31) + MIDDLE_WIDTH - 1) / MIDDLE_WIDTH;
+    static const uint32_t LAST_SCALE =
+      ((1UL << 31) + LAST_WIDTH - 1) / LAST_WIDTH;
+
+    uint8_t mCurVal;
+    uint8_t mPrevVal;
+    uint16_t mCurValRaw;
+    uint16_t mCurLower;  // start point of curVal in the input range (0 to 1023)
+    uint16_t mCurUpper;  // end point of curVal in the input range (0 to 1023)
+
+    void updateThresholds()
+    {
+      uint16_t lower = mCurVal * STEP;
+      mCurLower = (mCurVal == 0) ? 0 : lower - Hysteresis;
+      mCurUpper = (mCurVal == MAX_VALUE) ? 1023 : lower + STEP + Hysteresis;
+    }
+
+  public:
+    DiscreteKnob() : mCurVal(0), mPrevVal(0), mCurValRaw(0)
+    {
+      updateThresholds();
+    }
+
+    // Call once per loop with the read analog input value.
+    void update(uint16_t value)
+    {
+      if (value > 1023)
+        value = 1023;
+      mCurValRaw = value;
+      mPrevVal = mCurVal;
+
+      if (value < mCurLower || value > mCurUpper) {
+        uint16_t index = STEP_IS_POWER_OF_TWO ?
+          value >> STEP_SHIFT :
+          ((uint32_t)value * STEP_RECIPROCAL) >> RECIPROCAL_SHIFT;
+        // The last value also gets the remainder of the input range.
+        mCurVal = (index > MAX_VALUE) ? MAX_VALUE : index;
+        updateThresholds();
+      }
+    }
+
+    // Retrieve the current discrete value (0 to numValues-1).
+    uint8_t getValue() const
+    {
+      return mCurVal;
+    }
+
+    // Retrieve the raw value of the knob.
+    uint16_t getValueRaw() const
+    {
+      return mCurValRaw;
+    }
+
+    // Whether the value changed since last loop.
+    bool valueChanged() const
+    {
+      return mPrevVal != mCurVal;
+    }
+
+    // Map the knob's value from its discrete range onto some output range.
+    uint32_t mapValue(uint32_t lower, uint32_t upper) const
+    {
+      uint16_t frac = ((uint32_t)mCurVal * VALUE_SCALE) >> 9;
+      return lerp<15>(lower, upper, frac);
+    }
+
+    // Map the "inner value" of the knob to some output range.
+    // The inner value is how far between the current bounds the knob is.
+    // For example, if numValues is 2 and the knob is at 25%, then
+    // the inner value is 50% (halfway between 0 and 512)
+    uint32_t mapInnerValue(uint32_t lower, uint32_t upper) const
+    {
+      uint32_t scale = (mCurVal == 0) ? FIRST_SCALE :
+                       (mCurVal == MAX_VALUE) ? LAST_SCALE : MIDDLE_SCALE;
+      uint16_t offset = mCurValRaw - mCurLower;
+      uint16_t frac = (offset * scale) >> 16;
+      return lerp<15>(lower, upper, frac);
+    }
+  };
+
+  // Out-of-class definitions, since mapInnerValue() and friends pick between
+  // these in ?: expressions, which take their address.
+  template<uint16_t NumValues, uint8_t Hysteresis>
+  const uint8_t DiscreteKnob<NumValues, Hysteresis>::MAX_VALUE;
+  template<uint16_t NumValues, uint8_t Hysteresis>
+  const uint16_t DiscreteKnob<NumValues, Hysteresis>::STEP;
+  template<uint16_t NumValues, uint8_t Hysteresis>
+  const uint32_t DiscreteKnob<NumValues, Hysteresis>::FIRST_SCALE;
+  template<uint16_t NumValues, uint8_t Hysteresis>
+  const uint32_t DiscreteKnob<NumValues, Hysteresis>::MIDDLE_SCALE;
+  template<uint16_t NumValues, uint8_t Hysteresis>
+  const uint32_t DiscreteKnob<NumValues, Hysteresis>::LAST_SCALE;
+
+  /**
+   * DiscreteKnob whose number of values and hysteresis can be changed at
+   * runtime. update() divides by the step size and the map functions use
+   * map(), so prefer the template above when these are known up front.
+   */
+  template<>
+  class DiscreteKnob<0, 0> {
   public:
     // numValues min: 1
     // numValues max: 256
@@ -273,17 +1414,65 @@ namespace JNTUB {
    * A knob that maps the input range of signals (0 to 1023) onto an arbitrary
    * piecewise-linear curve specified by an array.
    *
-   * Optimized for inputs that don't change drastically or frequently.
+   * Optimized for inputs that don't change drastically or frequently:
+   * nothing is recomputed unless the reading changes, the slope of the
+   * current segment is worked out (with a divide) only when the knob moves
+   * into a new segment, and the output value only when the knob moves by a
+   * step. getValue() just returns the cached value, and
+   * valueChanged() lets callers skip their own work when it didn't move.
+   *
+   * The curve lives in SRAM by default. Pass ProgmemStorage for a curve
+   * declared PROGMEM; it costs an LPM per point read, and those reads only
+   * happen when the knob moves.
    *
    * Note: the higher the granularity, the more suceptible to noise it is.
    */
-  template<typename T>
+  template<typename T, typename Storage = RamStorage>
   class CurveKnob {
   public:
-    DiscreteKnob mSegmentKnob;
-    DiscreteKnob mHysteresisKnob;
+    DiscreteKnob<> mSegmentKnob;
+    DiscreteKnob<> mHysteresisKnob;
     const T *mCurve;
 
+  private:
+    // Slope of the current segment per step of mHysteresisKnob, with
+    // mSlopeShift fractional bits (as many as fit in 30 bits).
+    int32_t mSlope;
+    uint8_t mSlopeShift;
+    T mValue;
+    // Reading at the last update()
+    uint16_t mRaw;
+    // Whether the value needs working out even if the knob didn't move
+    bool mDirty;
+    bool mChanged;
+
+    void updateSlope()
+    {
+      uint8_t segment = mSegmentKnob.getValue();
+      int32_t rise = (int32_t)Storage::read(mCurve, segment+1) -
+                     (int32_t)Storage::read(mCurve, segment);
+      uint32_t magnitude = (rise < 0) ? -rise : rise;
+      uint8_t shift = 0;
+      while (magnitude && magnitude < ((uint32_t)1 << 29)) {
+        magnitude <<= 1;
+        ++shift;
+      }
+      mSlopeShift = shift;
+      uint8_t steps = mHysteresisKnob.mMaxVal;
+      mSlope = steps ? (rise * ((int32_t)1 << shift)) / steps : 0;
+    }
+
+    T computeValue() const
+    {
+      uint8_t segment = mSegmentKnob.getValue();
+      uint8_t step = mHysteresisKnob.getValue();
+      // Land exactly on the end of the segment despite the rounded slope.
+      if (step && step == mHysteresisKnob.mMaxVal)
+        return Storage::read(mCurve, segment+1);
+      return Storage::read(mCurve, segment) +
+             (T)((mSlope * step) >> mSlopeShift);
+    }
+
   public:
     CurveKnob(
         const T *curve,
@@ -293,25 +1482,58 @@ namespace JNTUB {
       : mSegmentKnob(size-1, 0),
         mHysteresisKnob(granularity, hysteresis),
         mCurve(curve)
-    {}
+    {
+      updateSlope();
+      mValue = computeValue();
+      mRaw = UINT16_MAX;  // not a reading
+      mDirty = true;
+      mChanged = true;
+    }
 
     void setCurve(const T *curve)
     {
       mCurve = curve;
+      mDirty = true;
     }
 
     // Call once per loop with the read analog input value.
     void update(uint16_t value)
     {
+      // Same reading, same result; skip mapInnerValue() (a multiply and
+      // divide on the runtime DiscreteKnob).
+      if (value == mRaw && !mDirty) {
+        mChanged = false;
+        return;
+      }
+      mRaw = value;
+
       mSegmentKnob.update(value);
       mHysteresisKnob.update(mSegmentKnob.mapInnerValue(0, 1023));
+
+      bool newSegment = mSegmentKnob.valueChanged();
+      if (mDirty || newSegment)
+        updateSlope();
+
+      mChanged = false;
+      if (mDirty || newSegment || mHysteresisKnob.valueChanged()) {
+        T value = computeValue();
+        mChanged = mDirty || value != mValue;
+        mValue = value;
+        mDirty = false;
+      }
     }
 
     // Retrieve the current mapped value (curve[0] to curve[size-1]).
     T getValue() const
     {
-      uint8_t segment = mSegmentKnob.getValue();
-      return mHysteresisKnob.mapValue(mCurve[segment], mCurve[segment+1]);
+      return mValue;
+    }
+
+    // Whether getValue() changed during the last update() (or the knob was
+    // just created, or given a new curve).
+    bool valueChanged() const
+    {
+      return mChanged;
     }
 
     uint16_t getValueRaw() const
@@ -320,14 +1542,127 @@ namespace JNTUB {
     }
   };
 
+  /**
+   * A value derived from an input (e.g. a rate computed from a knob) that is
+   * recomputed only when the input changes.
+   *
+   * The transform is a plain function of the input. Handing a new value to
+   * the ISR is up to the caller, e.g. with interrupts disabled around a
+   * FastClock::setRate() when update() returns true.
+   *
+   * Inputs should already be denoised (see the smoothers and knobs above);
+   * otherwise they'll "change" on most loops anyway.
+   */
+  template<typename In, typename Out>
+  class Param {
+  public:
+    typedef Out (*Transform)(In input);
+
+  private:
+    Transform mTransform;
+    In mInput;
+    Out mValue;
+    bool mValid;
+
+  public:
+    Param(Transform transform)
+      : mTransform(transform),
+        mInput(),
+        mValue(),
+        mValid(false)
+    {}
+
+    // Call once per loop. Runs the transform only if the input changed (or
+    // on the first call). Returns whether it did.
+    bool update(In input)
+    {
+      if (mValid && input == mInput)
+        return false;
+      mInput = input;
+      mValid = true;
+      mValue = mTransform(input);
+      return true;
+    }
+
+    // Make the next update() recompute even if the input is the same, e.g.
+    // when something else the transform depends on has changed.
+    void invalidate()
+    {
+      mValid = false;
+    }
+
+    Out getValue() const
+    {
+      return mValue;
+    }
+  };
+
+  // Picks the narrowest index type for a power-of-two RingIndex.
+  template<bool FitsInByte>
+  struct RingIndexType {
+    typedef uint16_t Type;
+  };
+
+  template<>
+  struct RingIndexType<true> {
+    typedef uint8_t Type;
+  };
+
+  /**
+   * Index arithmetic for a ring of N slots.
+   *
+   * If N is a power of two, wrapping around is a single AND with no
+   * branches, and if N is also no more than 256 the index is a single byte.
+   * Any other N falls back to a 16-bit index with compare-and-branch wrapping.
+   */
+  template<unsigned N, bool PowerOfTwo = ((N & (N - 1)) == 0)>
+  struct RingIndex {
+    typedef uint16_t Type;
+
+    // Position after i.
+    static inline Type next(Type i)
+    {
+      ++i;
+      return (i >= N) ? 0 : i;
+    }
+
+    // Position offset slots before i (offset < N).
+    static inline Type back(Type i, uint16_t offset)
+    {
+      return (offset > i) ? i + (N - offset) : i - offset;
+    }
+  };
+
+  template<unsigned N>
+  struct RingIndex<N, true> {
+    typedef typename RingIndexType<(N <= 256)>::Type Type;
+    static const Type MASK = N - 1;
+
+    static inline Type next(Type i)
+    {
+      return (i + 1) & MASK;
+    }
+
+    static inline Type back(Type i, uint16_t offset)
+    {
+      return (i - offset) & MASK;
+    }
+  };
+
   /**
    * Indexable, FIFO ring buffer.
+   *
+   * buffer[0] is the most recently pushed item, buffer[1] the one before
+   * that, and so on up to buffer[N-1]. Choose a power-of-two N if it is
+   * read in a hot path (see RingIndex).
    */
   template<typename T, unsigned N>
   class RingBuffer {
   private:
+    typedef RingIndex<N> Index;
+
     T buf[N];
-    uint16_t front;
+    typename Index::Type front;
 
   public:
     RingBuffer()
@@ -337,14 +1672,13 @@ namespace JNTUB {
 
     inline void fill(T value)
     {
-      memset(&buf[0], 0, N * sizeof(T));
+      for (uint16_t i = 0; i < N; ++i)
+        buf[i] = value;
     }
 
     inline T & extend()
     {
-      ++front;
-      if (front >= N)
-        front = 0;
+      front = Index::next(front);
       return buf[front];
     }
 
@@ -355,12 +1689,212 @@ namespace JNTUB {
 
     inline T & operator[](uint16_t i)
     {
-       if (i > front)
-         return buf[N-(i-front)];
-       return buf[front-i];
+      return buf[Index::back(front, i)];
+    }
+
+    // Read between two delays by linear interpolation.
+    // delay is a fixed-point number of samples with FracBits fractional
+    // bits; its integer part must be less than N-1.
+    template<uint8_t FracBits>
+    inline T fractionalDelay(uint16_t delay)
+    {
+      typename Index::Type pos = Index::back(front, delay >> FracBits);
+      uint16_t frac = delay & ((1U << FracBits) - 1);
+      return lerp<FracBits>(buf[pos], buf[Index::back(pos, 1)], frac);
+    }
+  };
+
+  /**
+   * A delay line of N int8_t samples that only stores 4 bits per sample,
+   * two samples per byte. Same interface as RingBuffer<int8_t, N>, except
+   * that operator[] returns a value rather than a reference.
+   *
+   * Meant for things like Karplus-Strong strings, where the length of the
+   * delay line sets the lowest note and SRAM is what runs out first.
+   *
+   * With BlockSize = 0, samples are simply rounded to their top 4 bits.
+   *
+   * With BlockSize > 0, every BlockSize consecutive samples share an
+   * exponent (block floating point), so quiet signals keep 4 bits of
+   * resolution instead of fading into the bottom step. The exponent of a
+   * block is chosen when writing starts on it, from the peak of the block
+   * before it, and may only get finer by one step per block. If a sample is
+   * too loud for it, the block is made coarser right away and the samples
+   * already written to it are requantized, so a loud attack after silence
+   * isn't clipped. Since a block's exponent is replaced as soon as writing
+   * starts on it, reads more than N - BlockSize samples back are not valid.
+   *
+   * SRAM used: N/2 bytes of samples plus N/BlockSize bytes of exponents.
+   */
+  template<unsigned N, uint8_t BlockSize=0>
+  class PackedDelayLine {
+  private:
+    static_assert(N % 2 == 0, "N must be even");
+    static_assert((BlockSize & (BlockSize - 1)) == 0,
+                  "BlockSize must be a power of two");
+    static_assert(BlockSize == 0 || N % BlockSize == 0,
+                  "BlockSize must divide N");
+
+    typedef RingIndex<N> Index;
+
+    // Largest exponent: 4 left shifts turn a 4-bit sample into a full byte.
+    static const uint8_t MAX_SHIFT = 4;
+    static const unsigned NUM_BLOCKS = BlockSize ? N / BlockSize : 1;
+
+    uint8_t mData[N / 2];
+    // Per block: how far samples were shifted left before keeping the top
+    // nibble (0 = coarsest, MAX_SHIFT = finest).
+    uint8_t mShifts[NUM_BLOCKS];
+    typename Index::Type mFront;
+    uint8_t mShift;  // shift of the block being written
+    uint8_t mPeak;   // peak magnitude written to that block so far
+
+    static inline uint16_t blockOf(uint16_t pos)
+    {
+      return BlockSize ? pos / BlockSize : 0;
+    }
+
+    void startBlock()
+    {
+      // Coarsest shift that still fits the previous block's peak...
+      uint8_t shift = 0;
+      for (uint8_t peak = mPeak; peak < 64 && shift < MAX_SHIFT; peak <<= 1)
+        ++shift;
+      // ...but only get finer gradually, so a momentary lull doesn't make
+      // the next block clip.
+      if (shift > mShift + 1)
+        shift = mShift + 1;
+
+      mShift = shift;
+      mShifts[blockOf(mFront)] = shift;
+      mPeak = 0;
+    }
+
+    inline uint8_t getNibble(uint16_t pos) const
+    {
+      uint8_t byte = mData[pos >> 1];
+      return (pos & 0x01) ? (byte >> 4) : (byte & 0x0F);
+    }
+
+    inline void setNibble(uint16_t pos, uint8_t nibble)
+    {
+      uint8_t &byte = mData[pos >> 1];
+      if (pos & 0x01)
+        byte = (byte & 0x0F) | (nibble << 4);
+      else
+        byte = (byte & 0xF0) | nibble;
+    }
+
+    // Make the block being written coarse enough for magnitude, and
+    // requantize what's already been written to it. Happens at most
+    // MAX_SHIFT times per block, on the attack of a note.
+    void coarsen(uint8_t magnitude)
+    {
+      uint8_t shift = mShift;
+      while (shift > 0 && ((uint16_t)magnitude << shift) > INT8_MAX)
+        --shift;
+      uint8_t drop = mShift - shift;
+
+      typename Index::Type pos = mFront & ~(typename Index::Type)(BlockSize - 1);
+      for (; pos != mFront; ++pos) {
+        // Sign-extend the nibble, then shift it down to the new exponent.
+        int8_t value = (int8_t)(getNibble(pos) << 4) >> drop;
+        setNibble(pos, ((uint8_t)value >> 4) & 0x0F);
+      }
+
+      mShift = shift;
+      mShifts[blockOf(mFront)] = shift;
+    }
+
+  public:
+    PackedDelayLine()
+    {
+      mFront = 0;
+      fill(0);
+    }
+
+    void fill(int8_t value)
+    {
+      mShift = 0;
+      mPeak = 0;
+      memset(mShifts, 0, sizeof(mShifts));
+      uint8_t nibble = encode(value, 0);
+      memset(mData, nibble | (nibble << 4), sizeof(mData));
+    }
+
+    // Round to the nearest 4-bit step (saturating), return that nibble.
+    static inline uint8_t encode(int8_t value, uint8_t shift)
+    {
+      int16_t scaled = ((int16_t)value << shift) + 8;
+      if (scaled > INT8_MAX)
+        scaled = INT8_MAX;
+      else if (scaled < INT8_MIN)
+        scaled = INT8_MIN;
+      return (uint8_t)scaled >> 4;
+    }
+
+    inline void push(int8_t value)
+    {
+      mFront = Index::next(mFront);
+      if (BlockSize && (mFront & (BlockSize - 1)) == 0)
+        startBlock();
+
+      // One's complement absolute value is close enough and can't overflow.
+      uint8_t magnitude = value ^ (value >> 7);
+      if (magnitude > mPeak) {
+        mPeak = magnitude;
+        if (BlockSize && ((uint16_t)magnitude << mShift) > INT8_MAX)
+          coarsen(magnitude);
+      }
+
+      setNibble(mFront, encode(value, mShift));
+    }
+
+    inline int8_t operator[](uint16_t i) const
+    {
+      typename Index::Type pos = Index::back(mFront, i);
+      uint8_t byte = mData[pos >> 1];
+      // Put the nibble in the top half so the shift sign-extends it.
+      int8_t value = (pos & 0x01) ? (byte & 0xF0) : (byte << 4);
+      return value >> mShifts[blockOf(pos)];
     }
   };
 
+  /**
+   * Cheap pseudo-random number generator.
+   *
+   * The C library random() is WAY too expensive to call once per sample.
+   * This is a 16-bit xorshift generator (shift triple 7, 9, 8; period
+   * 2^16 - 1), which on AVR boils down to a few byte moves, shifts and XORs.
+   *
+   * Most of the time we only need a coin flip or a few random bits, so
+   * nextBit() and nextBits() hand out the bits of each 16-bit state one
+   * chunk at a time, and only advance the generator when they run out.
+   *
+   * Not remotely suitable for anything security related, obviously.
+   */
+  class Random {
+  public:
+    Random(uint16_t seed=1);
+
+    // Restart the sequence. A seed of 0 is replaced with 1 (xorshift
+    // generators get stuck at 0).
+    void     seed(uint16_t seed);
+
+    // Advance the generator and return its new 16-bit state.
+    uint16_t next();
+
+    // Random bits from the buffered bit stream.
+    bool     nextBit();
+    uint8_t  nextBits(uint8_t n);  // 1 <= n <= 8
+    uint8_t  nextByte();
+
+  public:
+    uint16_t mState;
+    // Bits of a previous state that have not been handed out yet.
+    uint16_t mBits;
+    uint8_t  mBitsLeft;
+  };
 
   /**
    * Simple class, reports rising and falling edges.
@@ -412,21 +1946,41 @@ namespace JNTUB {
 
   /**
    * A clock generator that also reports phase.
+   *
+   * Its phase is a 32-bit accumulator: each update() advances it by the time
+   * elapsed since the last update() times a per-time-unit increment,
+   * 2^32 / period. Working the increment out takes a divide, but only when
+   * the period changes; updating takes a single multiply (32x32, so still
+   * a few hundred cycles in software on the ATtiny85).
+   *
+   * The increment is rounded down, so periods run long by at most
+   * period / 2^32 of a period (under 0.03% for periods up to a second in
+   * microseconds).
    */
   class Clock {
   public:
-    Stopwatch mStopwatch;
     uint32_t mPeriod;
+    // Phase added per unit of time
+    uint32_t mIncrement;
+    // Phase accumulator; the top 8 bits are the reported phase.
+    uint32_t mPhase;
+    // Time as of the last update(), if mHaveTime
+    uint32_t mLastTime;
+    uint8_t mHaveTime;
     uint8_t mDuty;
-    uint8_t mCurPhase;
     uint8_t mRunning;
     uint8_t mPrevState;
+    // EDGE_* flags for edges the phase passed during the last update()
+    uint8_t mEdges;
+
+    static const uint8_t EDGE_RISING = 0x01;
+    static const uint8_t EDGE_FALLING = 0x02;
 
   public:
     Clock(uint32_t period=0);
 
     uint32_t getPeriod() const;
-    void     setPeriod(uint32_t period);
+    void     setPeriod(uint32_t period);  // **SLOW** (divides) if changed
 
     static const uint16_t PHASE_MAX = 256;
     uint8_t  getPhase() const;
@@ -441,12 +1995,136 @@ namespace JNTUB {
     bool     isFalling() const;
 
     // NOTE: call update() before modifying clock parameters
+    // start() restarts the phase from 0 as of the next update().
     void     start();
     void     stop();
     void     sync(uint8_t phase=0);
     void     update(uint32_t time);
   };
 
+  // Narrowest integer type with the given number of bytes.
+  template<uint8_t Bytes> struct PhaseStorage {};
+
+  template<> struct PhaseStorage<1> {
+    typedef uint8_t Type;
+  };
+  template<> struct PhaseStorage<2> {
+    typedef uint16_t Type;
+  };
+#if defined(__AVR__)
+  template<> struct PhaseStorage<3> {
+    typedef __uint24 Type;
+  };
+#else
+  template<> struct PhaseStorage<3> {
+    typedef uint32_t Type;
+  };
+#endif
+  template<> struct PhaseStorage<4> {
+    typedef uint32_t Type;
+  };
+
+  // Cycle counter for PhaseAccumulator. Takes no space when not counting.
+  template<bool CountCycles>
+  class PhaseCycleCounter {
+  protected:
+    inline void countCycles(bool) {}
+
+  public:
+    uint32_t getNumCycles() const { return 0; }
+    void addCycles(uint16_t) {}
+  };
+
+  template<>
+  class PhaseCycleCounter<true> {
+  protected:
+    // Written every tick, so usually from an interrupt.
+    volatile uint32_t mCycles;
+
+    PhaseCycleCounter() : mCycles(0) {}
+
+    // Add rather than branch, so ticking takes the same time either way.
+    inline void countCycles(bool wrapped) { mCycles += wrapped; }
+
+  public:
+    uint32_t getNumCycles() const { return mCycles; }
+    void addCycles(uint16_t cycles) { mCycles += cycles; }
+  };
+
+  /**
+   * A Bits-bit phase accumulator: adds an increment to the phase every tick,
+   * wrapping around from 2^Bits - 1 to 0 at the end of every cycle.
+   *
+   * The phase is stored in the narrowest of 8, 16, 24 or 32 bits that fits,
+   * since every extra byte costs cycles on every tick. When Bits fills its
+   * storage exactly, wrapping is free (plain integer overflow). Otherwise,
+   * the carry out of the top phase bit is tested and cleared.
+   *
+   * With CountCycles, also counts completed cycles (32-bit).
+   */
+  template<uint8_t Bits, bool CountCycles=false>
+  class PhaseAccumulator : public PhaseCycleCounter<CountCycles> {
+  public:
+    static_assert(Bits >= 1 && Bits <= 32, "phase must be 1 to 32 bits");
+
+    typedef typename PhaseStorage<(Bits + 7) / 8>::Type Phase;
+
+    static const uint8_t PHASE_BITS = Bits;
+    // Whether wrapping happens naturally by integer overflow.
+    static const bool NATURAL_WRAP = (sizeof(Phase) * 8 == Bits);
+    // Largest phase (and largest increment).
+    static const Phase PHASE_MASK =
+      (Phase)(~(Phase)0) >> (sizeof(Phase) * 8 - Bits);
+
+    Phase mPhase;
+    Phase mIncrement;
+
+    PhaseAccumulator() : mPhase(0), mIncrement(0) {}
+
+    inline Phase getPhase() const { return mPhase; }
+    inline void setPhase(Phase phase) { mPhase = phase & PHASE_MASK; }
+
+    inline Phase getIncrement() const { return mIncrement; }
+    // 0 <= increment <= PHASE_MASK
+    inline void setIncrement(Phase increment) { mIncrement = increment; }
+
+    // Advance by one increment. Returns true if the phase wrapped around.
+    inline bool tick()
+    {
+      bool wrapped;
+      mPhase += mIncrement;
+      if (NATURAL_WRAP) {
+        // Overflowed iff the sum came out smaller than what was added.
+        wrapped = mPhase < mIncrement;
+      } else {
+        // Carry out of the top phase bit.
+        wrapped = mPhase > PHASE_MASK;
+        mPhase &= PHASE_MASK;
+      }
+      this->countCycles(wrapped);
+      return wrapped;
+    }
+
+    // Top IndexBits bits of the phase, e.g. to index a 2^IndexBits table.
+    template<uint8_t IndexBits>
+    inline uint16_t index() const
+    {
+      static_assert(IndexBits <= Bits && IndexBits <= 16, "bad index width");
+      return (uint16_t)(mPhase >> (Bits - IndexBits));
+    }
+
+    // The FracBits bits of the phase just below the top IndexBits bits,
+    // i.e. how far the phase is between index() and index() + 1.
+    template<uint8_t IndexBits, uint8_t FracBits>
+    inline uint16_t fraction() const
+    {
+      static_assert(IndexBits + FracBits <= Bits && FracBits <= 16,
+                    "bad fraction width");
+      return (uint16_t)(mPhase >> (Bits - IndexBits - FracBits)) &
+             (uint16_t)((1UL << FracBits) - 1);
+    }
+  };
+
   /**
    * A more performance-sensitive clock. Meant to be updated on a regular
    * timer interrupt.
@@ -455,25 +2133,32 @@ namespace JNTUB {
     private:
       // How many microseconds elapse per tick
       const uint16_t mMicrosPerTick;
-      // Phase accumulator
-      uint32_t mCurPhase;
+      // Phase accumulator. Also counts how many periods the clock has
+      // completed since construction.
+      // Its increment is mRate while running and 0 while stopped, so tick()
+      // doesn't have to check whether the clock is running.
+      PhaseAccumulator<32, true> mPhase;
       // Sets how much phase accumulates per tick
       volatile uint32_t mRate;
       // Phase at which the clock switches from high to low
       volatile uint32_t mDuty;
-      // How many periods the clock has completed since construction
-      volatile uint32_t mCycles;
       // Whether or not the clock is advancing
-      bool mRunning: 1;
-      // What state the clock was in last tick
-      bool mPrevState: 1;
+      bool mRunning;
+      // EDGE_* flags for the last tick() or advance().
+      // tick() only records whether the phase wrapped around (started a new
+      // period); falling edges are worked out only when asked for.
+      uint8_t mEdges;
+
+      static const uint8_t EDGE_RISING = 0x01;
+      static const uint8_t EDGE_FALLING = 0x02;
+      // Set by advance(), which works out falling edges up front.
+      static const uint8_t EDGE_ADVANCED = 0x04;
 
     public:
-      // The clock's phase has 30-bit granularity.
-      // The phase advances from 0 to 2^30 - 1 and then wraps around to start
-      // the next period.
-      static const uint8_t PHASE_BITS = 30;
-      static const uint32_t PHASE_MAX = (uint32_t)1<<PHASE_BITS;
+      // The clock's phase has 32-bit granularity.
+      // The phase advances from 0 to 2^32 - 1 and then wraps around to start
+      // the next period. Wrapping is just the 32-bit add overflowing.
+      static const uint8_t PHASE_BITS = 32;
 
       // Construct the FastClock specifying how frequently it will be updated.
       FastClock(uint16_t tickRateHz);
@@ -490,6 +2175,9 @@ namespace JNTUB {
       // **SLOW** (32-bit divide)
       uint32_t microsToRate(uint32_t micros) const;
 
+      // Reads the count with interrupts off, so it's callable from anywhere.
+      uint32_t getNumCycles() const;
+
       /* ---------------------------------------------------------------- */
       /* Callable during timer interrupt, or when interrupts are disabled */
       /* ---------------------------------------------------------------- */
@@ -498,15 +2186,20 @@ namespace JNTUB {
       void     setRate(uint32_t rate);
 
       // Clock is high when 0 <= phase < duty.
-      // Clock is low when duty <= phase < PHASE_MAX.
+      // Clock is low when duty <= phase <= 2^32 - 1.
       uint32_t getDuty() const;
       void     setDuty(uint32_t duty);
 
-      uint32_t getNumCycles() const;
-
       void     start();
       void     stop();
+      // Syncing from the low part of the period to the high part counts as a
+      // rising edge (for isRising() until the next tick()), as if the clock
+      // had started a new period.
       void     sync(uint32_t phase=0);
+      // Sync to an edge that happened elapsed (UQ0.8) of a tick ago: the
+      // phase is set to where it would be now, had it been synced right at
+      // the edge.
+      void     sync(uint32_t phase, uint8_t elapsed);
 
       /* ------------------------------------ */
       /* Only callable during timer interrupt */
@@ -515,10 +2208,24 @@ namespace JNTUB {
       uint32_t getPhase() const;
 
       bool     getState() const;
+      // Whether an edge happened during the last tick() or advance(), or a
+      // sync() since.
       bool     isRising() const;
       bool     isFalling() const;
 
+      // How many ticks ago the most recent rising/falling edge happened
+      // (0 = on the last tick). Only meaningful while isRising()/isFalling().
+      // Handy after advance(), to place an edge within the block.
+      // **SLOW** (32-bit divide)
+      uint32_t ticksSinceRising() const;
+      uint32_t ticksSinceFalling() const;
+
       void     tick();
+
+      // Same as calling tick() n times, in constant time (a couple of 16-bit
+      // multiplies). For updating the clock at control rate, e.g. once per
+      // block of samples.
+      void     advance(uint16_t n);
   };
 
   /**
@@ -562,7 +2269,36 @@ namespace JNTUB {
     /* ------------------------------------ */
 
     void     tick();
+    // Same as calling tick() n times.
+    void     advance(uint16_t n);
+
+  };
+
+  /**
+   * Timestamps edges of the GATE/TRG input to within a fraction of a timer
+   * tick. See GATE EDGE TIMING above.
+   */
+  class EdgeTimer {
+  private:
+    // Timer/Counter0 count at the last edge
+    volatile uint8_t mCount;
+    volatile bool mCaptured;
+    // 2^16 / (TOP + 1), for turning counts into fractions of a tick
+    uint16_t mScale;
+
+  public:
+    EdgeTimer();
+
+    // Call once during setup(), after setUpTimerInterrupt().
+    void begin();
 
+    // Call from ISR(GATE_INTERRUPT).
+    void capture();
+
+    // Call once per timer interrupt, as early in it as possible. Fraction
+    // of a tick (UQ0.8) since the edge captured during the last tick, or 0
+    // if there wasn't one or it came after this tick had already started.
+    uint8_t elapsed();
   };
 
   /**
@@ -573,12 +2309,12 @@ namespace JNTUB {
    * (fastClock) to some incoming gate signal (gate):
    *
    *    timer interrupt:
-   *      approximator.tick(gate);
+   *      approximator.tick(gate, elapsed);
    *      // This keeps the FastClock's edges in lockstep with the input signal.
    *      if (approximator.isRising())
-   *        fastClock.sync(0);
+   *        fastClock.sync(0, elapsed);
    *      else if (approximator.isFalling())
-   *        fastClock.sync(fastClock.getDuty());
+   *        fastClock.sync(fastClock.getDuty(), elapsed);
    *
    *    main code:
    *      uint32_t rate, duty;
@@ -588,19 +2324,25 @@ namespace JNTUB {
    *      fastClock.setRate(rate);
    *      fastClock.setDuty(duty);
    *      interrupts();
+   *
+   * elapsed comes from an EdgeTimer, and places the edges to within 1/256 of
+   * a tick. Without one, pass 0 (or leave it out), and the edges are only
+   * as precise as the tick rate.
    */
   class FastClockApproximator {
   private:
     FastStopwatch mStopwatch;
     EdgeDetector mEdgeDetector;
-    // Number of ticks for which the input signal was high during its last
+    // Time (UQ24.8 ticks) for which the input signal was high during its last
     // completed period.
     volatile uint32_t mHighTicks;
-    // Number of ticks for which the input signal was low during its last
+    // Time (UQ24.8 ticks) for which the input signal was low during its last
     // completed period.
     volatile uint32_t mLowTicks;
-    // Store the number of high ticks here until the current period ends.
+    // Store the high time here until the current period ends.
     uint32_t mTmpTicks;
+    // How long before its tick the last edge happened (UQ0.8)
+    uint8_t mEdgeElapsed;
 
   public:
     FastClockApproximator(uint16_t tickRateHz);
@@ -610,8 +2352,13 @@ namespace JNTUB {
     /* ----------------------------------------------- */
 
     // **SLOW** (32-bit divide and multiply)
+    // Until a whole period has been seen, the rate is 0 and the duty 1/2.
     void calculateRateAndDuty(uint32_t *rateOut, uint32_t *dutyOut) const;
 
+    // High and low time of the last period, in UQ24.8 ticks. Cheap, so it
+    // can tell whether calculateRateAndDuty() would give anything new.
+    void getPeriod(uint32_t *highOut, uint32_t *lowOut) const;
+
     /* ---------------------------------------------------------------- */
     /* Callable during timer interrupt, or when interrupts are disabled */
     /* ---------------------------------------------------------------- */
@@ -619,6 +2366,7 @@ namespace JNTUB {
     bool     isRising() const;
     bool     isFalling() const;
 
+    // In whole ticks
     uint32_t getHighTicks() const;
     uint32_t getLowTicks() const;
 
@@ -626,7 +2374,11 @@ namespace JNTUB {
     /* Only callable during timer interrupt */
     /* ------------------------------------ */
 
-    void     tick(bool gate);
+    // elapsed: see EdgeTimer::elapsed()
+    void     tick(bool gate, uint8_t elapsed=0);
+    // Same as calling tick() n times, with the gate only sampled on the last
+    // one. Edges are only seen at block granularity.
+    void     advance(uint16_t n, bool gate, uint8_t elapsed=0);
 
   };
 
@@ -635,11 +2387,17 @@ namespace JNTUB {
    * signal is a repeating clock signal or just a series of unrelated
    * gates/triggers.
    *
-   * The signal will be recognized as a clock signal if:
-   *  - There are 3 consecutive periods with roughly* the same length, AND
-   *  - The duty cycle of all 3 periods is greater than some threshold (1/8)
+   * The lengths of the last WINDOW periods are kept in a small ring, along
+   * with their running sum. The signal will be recognized as a clock signal
+   * if:
+   *  - 4 periods in a row are each within 1/8 of their mean length, or
+   *      within 32 ms of it for periods longer than 256 ms, AND
+   *  - The duty cycle of the latest period is greater than some threshold (1/8)
    *
-   *  * See MARGIN_OF_ERROR_MICROS.
+   * The tolerance is relative, so fast clocks with a bit of swing or jitter
+   * lock as readily as slow ones, and unrelated triggers a few milliseconds
+   * apart don't. It's capped for slow clocks, where 1/8 of a period would
+   * let irregular triggers through.
    *
    * Once the input signal has been recognized as a clock signal, it won't
    * be unrecognized until:
@@ -653,10 +2411,23 @@ namespace JNTUB {
     // The number of ticks that elapse in one millisecond.
     const uint8_t mTicksPerMillis;
 
-    // Number of ticks for which the input was high during the last period
-    uint32_t mPrevHighTicks;
-    // Number of ticks for which the input was low during the last period
-    uint32_t mPrevLowTicks;
+    static const uint8_t WINDOW_BITS = 2;
+    static const uint8_t WINDOW = 1 << WINDOW_BITS;
+    // Periods must be within mean / 2^TOLERANCE_BITS of the mean.
+    static const uint8_t TOLERANCE_BITS = 3;
+    // ...but never more than this many milliseconds away.
+    static const uint8_t MAX_TOLERANCE_MS = 32;
+
+    // Lengths (in ticks) of the last few periods, and their sum
+    uint32_t mPeriods[WINDOW];
+    uint32_t mPeriodSum;
+    // Where the next period goes in mPeriods
+    uint8_t mPeriodIndex;
+    // How many of mPeriods are filled (0 to WINDOW)
+    uint8_t mNumPeriods;
+
+    // Length of the latest period
+    uint32_t mLastPeriod;
 
     // Counts the number of ticks that have elapsed since the last rising
     // edge of the input signal.
@@ -664,14 +2435,6 @@ namespace JNTUB {
 
     mutable bool mIsClock;
 
-    // When mIsClock is false, this counts the number of periods in a row that
-    // have been roughly the same length and whose duty cycle has been
-    // sufficiently large.
-    uint8_t mNumGoodPeriods;
-
-    // MARGIN_OF_ERROR_MILLIS = 32 (i.e., 2^5)
-    static const uint8_t MARGIN_OF_ERROR_BITS = 5;
-
   public:
     ClockDetector(uint16_t tickRateHz);
 
@@ -695,10 +2458,245 @@ namespace JNTUB {
     /* Only callable during timer interrupt */
     /* ------------------------------------ */
 
-    void tick(bool gate);
+    // elapsed: see EdgeTimer::elapsed()
+    void tick(bool gate, uint8_t elapsed=0);
+
+  private:
+    void addPeriod(uint32_t period);
+    void clearPeriods();
+    bool periodsAreSteady() const;
+  };
+
+  /**
+   * Phase-locked loop that keeps a FastClock (the "follower") in step with
+   * an incoming clock signal.
+   *
+   * Rather than jumping to the length of the last period at every edge (as
+   * FastClockApproximator does), it nudges the follower's phase and rate by
+   * a fraction of the phase error seen at each rising edge of the input
+   * (a PI loop filter). Input jitter is smoothed out, and tracking costs only
+   * shifts and adds per edge.
+   *
+   * Until it locks, the follower is synced to each edge, and set to the
+   * rate for the measured period. That takes a divide, so tick() only
+   * records the period and update() (from main code) does the divide. It
+   * locks once the edges land close to where the follower expects them a
+   * few times in a row, and unlocks if an edge is way off or if the input
+   * stops for 4 periods.
+   *
+   *    timer interrupt:
+   *      pll.tick(gate);
+   *      // pll.getClock() is the smoothed input clock, and
+   *      // pll.isClockRising() the start of each of its periods.
+   *
+   *    main code:
+   *      pll.update();
+   *      if (pll.isLocked()) {
+   *        noInterrupts();
+   *        uint32_t rate = pll.getRate();
+   *        interrupts();
+   *        ...
+   *      }
+   */
+  class ClockPLL {
+  private:
+    FastClock mFollower;
+    EdgeDetector mEdgeDetector;
+    // Ticks since the last rising edge of the input
+    uint32_t mTicksSinceEdge;
+    // How long before its tick the last rising edge happened (UQ0.8)
+    uint8_t mEdgeElapsed;
+    // Follower's cycle count at the last rising edge of the input
+    uint32_t mEdgeCycles;
+    // Loop gain shifts: phase error >> mBandwidth goes to the phase and
+    // (scaled to the rate) >> 2 * mBandwidth to the rate.
+    uint8_t mBandwidth;
+    // Edges in a row that landed within LOCK_ERROR while acquiring
+    uint8_t mGoodEdges;
+    volatile bool mLocked;
+    bool mHavePeriod;
+    // Last period measured while acquiring (UQ24.8 ticks), for update() to
+    // set the follower's rate from. 0 when there is none.
+    volatile uint32_t mNewPeriod;
+    // Position of the highest set bit of the follower's rate, kept up to
+    // date by update() for track().
+    volatile uint8_t mRateBits;
+    // See isClockRising()
+    bool mClockRising;
+
+    // Edges must land within 1/16 of a period to lock...
+    static const uint32_t LOCK_ERROR = (uint32_t)1 << 28;
+    // ...and the loop unlocks if one lands more than 1/4 period off.
+    static const uint32_t UNLOCK_ERROR = (uint32_t)1 << 30;
+    static const uint8_t EDGES_TO_LOCK = 3;
+    static const uint8_t PERIODS_TO_UNLOCK = 4;
+
+    void acquire(int32_t error, uint8_t elapsed);
+    // Returns false (and does nothing) if the error is too big to track.
+    bool track(int32_t error);
+
+  public:
+    ClockPLL(uint16_t tickRateHz);
+
+    /* ----------------------------------------------- */
+    /* Callable from main code with interrupts enabled */
+    /* ----------------------------------------------- */
+
+    // Larger values narrow the loop bandwidth: it takes roughly 2^bandwidth
+    // input periods to settle, and filters out more of the input's jitter.
+    // Defaults to 2.
+    void setBandwidth(uint8_t bandwidth);
+
+    // Call regularly, e.g. once per loop(). **SLOW** (divides) after each
+    // input edge until the loop locks.
+    void update();
+
+    bool isLocked() const;
+
+    /* ---------------------------------------------------------------- */
+    /* Callable during timer interrupt, or when interrupts are disabled */
+    /* ---------------------------------------------------------------- */
+
+    // The follower clock, at the input clock's rate and phase.
+    const FastClock &getClock() const;
+    // Start of a period of the follower clock during the last tick. Until
+    // the loop locks, that's each rising edge of the input, since the
+    // follower is resynced to them; use this rather than
+    // getClock().isRising(), which only fires once it runs on its own.
+    bool isClockRising() const;
+    uint32_t getRate() const;
+    uint32_t getPhase() const;
+
+    // Edges of the input signal during the last tick.
+    bool isRising() const;
+    bool isFalling() const;
+
+    /* ------------------------------------ */
+    /* Only callable during timer interrupt */
+    /* ------------------------------------ */
+
+    // elapsed: see EdgeTimer::elapsed()
+    void tick(bool gate, uint8_t elapsed=0);
+  };
 
+  /**
+   * Derives a clock running at exactly numerator / denominator times the
+   * rate of an input clock, with its edges locked to the input's.
+   *
+   * Every denominator input periods (a "frame") span exactly numerator
+   * output periods. At each input edge, the output jumps to exactly where it
+   * should be within the frame, which it keeps track of with integer
+   * arithmetic: a 32-bit phase plus a remainder in 1/denominator units of
+   * its lowest bit (Bresenham style). Between input edges, the output
+   * advances at the input rate times the ratio, but never reaches where it
+   * should be at the next input edge until that edge actually arrives. So it
+   * neither drifts nor runs ahead of a slowing input clock, and output edges
+   * that coincide with input edges happen on those input edges.
+   *
+   * Dividing or multiplying the input rate takes a divide, but only in main
+   * code when the rate or ratio changes. tick() only adds and compares.
+   *
+   *    timer interrupt:
+   *      ratioClock.tick(inputEdgeDetector.isRising());
+   *      digitalWriteOut(ratioClock.getState());
+   *
+   *    main code:
+   *      ratioClock.setRatio(3, 2);
+   *      ratioClock.setInputRate(inputRate);  // e.g. from a ClockPLL
+   *
+   * A new ratio takes effect at the start of the next frame, so the output
+   * stays locked through the change.
+   */
+  class RatioClock {
   private:
-    bool mostRecentPeriodWasGood() const;
+    struct Ratio {
+      uint8_t numerator;
+      uint8_t denominator;
+      // Output distance per input period: wraps whole periods, plus
+      // (phase + error / denominator) / 2^32 of a period.
+      uint8_t wraps;
+      uint8_t error;
+      uint32_t phase;
+      // Output distance per tick, at the input rate:
+      // (increment + incrementError / denominator) / 2^32 of a period.
+      uint32_t increment;
+      uint8_t incrementError;
+    };
+
+    Ratio mRatio;
+    // Set by setRatio(), for tick() to switch to at the start of a frame
+    Ratio mNextRatio;
+    volatile bool mRatioPending;
+    // Input edges left in the current frame
+    uint8_t mFrameEdgesLeft;
+
+    // Output phase, plus mError / denominator of its lowest bit. The error
+    // terms are 16 bits wide because adding two of them (each below the
+    // denominator) can go past 255.
+    uint32_t mPhase;
+    uint16_t mError;
+    uint32_t mInputRate;
+
+    // Where the output will be at the next input edge is one past
+    // mHoldPhase, after mWrapsLeft more wraps. Until that edge, the output
+    // holds at mHoldPhase rather than going past it.
+    uint32_t mHoldPhase;
+    uint8_t mWrapsLeft;
+    uint16_t mNextError;
+
+    volatile uint32_t mDuty;
+    // Edges during the last tick
+    bool mRising;
+    bool mFalling;
+    // Whether the last tick started a frame
+    bool mFrameStart;
+
+    static void scaleRate(uint32_t rate, Ratio *ratio);
+    void moveTo(uint32_t phase, uint8_t wraps);
+
+  public:
+    RatioClock();
+
+    /* ----------------------------------------------- */
+    /* Callable from main code with interrupts enabled */
+    /* ----------------------------------------------- */
+
+    // 1 <= numerator, denominator <= 255. Best in lowest terms, since a frame
+    // is denominator input periods long. **SLOW** (divides) if changed.
+    void setRatio(uint8_t numerator, uint8_t denominator);
+
+    // Rate (FastClock phase per tick) of the input clock. **SLOW** (divides)
+    // if changed.
+    void setInputRate(uint32_t rate);
+
+    // Output is high for 0 <= phase < duty. Defaults to half a period.
+    void setDuty(uint32_t duty);
+
+    /* ---------------------------------------------------------------- */
+    /* Callable during timer interrupt, or when interrupts are disabled */
+    /* ---------------------------------------------------------------- */
+
+    // Hold the output low until the next input edge, which will start a
+    // frame (and switch to any new ratio).
+    void reset();
+
+    uint32_t getPhase() const;
+    uint32_t getDuty() const;
+    bool getState() const;
+    bool isRising() const;
+    bool isFalling() const;
+
+    // Whether the last tick was an input edge that started a frame.
+    bool isStartOfFrame() const;
+    // Numerator of the ratio currently in effect
+    uint8_t getNumerator() const;
+
+    /* ------------------------------------ */
+    /* Only callable during timer interrupt */
+    /* ------------------------------------ */
+
+    // inputRising: whether the input clock had a rising edge this tick.
+    void tick(bool inputRising);
   };
 
 }  //JNTUB
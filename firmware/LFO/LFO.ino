@@ -85,7 +85,7 @@
 #define TIMER_RATE JNTUB::SAMPLE_RATE_8_KHZ
 
 // LFO periods in microseconds (for free-running mode)
-const uint32_t PERIOD_CURVE[] = {
+const uint32_t PERIOD_CURVE[] PROGMEM = {
   180000000, // 3 min
   90000000,  // 90 sec
   50000000,  // 50 sec
@@ -117,42 +117,75 @@ const uint8_t MULTIPLIERS[] = {
   128,
 };
 
-const int8_t *const SHAPES[] = {
-  WT_SINE,
-  WT_TRIANGLE,
-  WT_RAMP,
-  WT_SAWTOOTH,
-  WT_SQUARE,
+// Wave shapes, in SHAPE knob order.
+// Only the sine needs a table; the rest are computed from the phase.
+enum Shape {
+  SHAPE_SINE,
+  SHAPE_TRIANGLE,
+  SHAPE_RAMP,
+  SHAPE_SAWTOOTH,
+  SHAPE_SQUARE,
+  NUM_SHAPES,
 };
 
-JNTUB::CurveKnob<uint32_t> rateKnob(PERIOD_CURVE, NELEM(PERIOD_CURVE));
+const SineTable SINE(WT_SINE_QUARTER);
 
-JNTUB::DiscreteKnob multiplyKnob(NELEM(MULTIPLIERS), 5);
-JNTUB::DiscreteKnob divideKnob(NELEM(MULTIPLIERS), 5);
+JNTUB::CurveKnob<uint32_t, JNTUB::ProgmemStorage> rateKnob(
+  PERIOD_CURVE, NELEM(PERIOD_CURVE));
+
+JNTUB::DiscreteKnob<NELEM(MULTIPLIERS), 5> multiplyKnob;
+JNTUB::DiscreteKnob<NELEM(MULTIPLIERS), 5> divideKnob;
 // These help ensure we don't sync() the LFO partway through its period
-// when its running off a divided input signal.
+// when it's running off a divided input signal.
 uint8_t division;  // 0 if not in divide mode
 uint8_t divides;   // number of periods that have passed
 
-JNTUB::DiscreteKnob shapeKnob(NELEM(SHAPES), 5);
+JNTUB::DiscreteKnob<NUM_SHAPES, 5> shapeKnob;
 
 JNTUB::FastClock lfoClock(TIMER_RATE);
 JNTUB::ClockDetector clockDetector(TIMER_RATE);
+// Follows the input clock's rate and phase once it's been detected,
+// smoothing out any jitter.
+JNTUB::ClockPLL clockFollower(TIMER_RATE);
+// Times the clock's edges to a fraction of a tick, so that its rate doesn't
+// depend on where its edges happen to fall between ticks.
+JNTUB::EdgeTimer edgeTimer;
+
+uint32_t periodToRate(uint32_t periodMicros)
+{
+  return lfoClock.microsToRate(periodMicros);
+}
+
+// Free-running rate from the RATE knob. Converting the period to a rate
+// takes a 32-bit divide, so it's only redone when the knob moves.
+JNTUB::Param<uint32_t, uint32_t> freeRunningRate(periodToRate);
+
+// Keep ADC noise from wobbling the output and from having the rate
+// recomputed every loop.
+JNTUB::AdaptiveSmoother<1, 5> shapeSmoother;
+JNTUB::AdaptiveSmoother<1, 5> phaseSmoother;
+JNTUB::AdaptiveSmoother<1, 5> rateSmoother;
 
 // Phase offset set by the PHASE knob.
 volatile uint8_t phaseOffset;
 
-// Wavetable selected by SHAPE knob.
-volatile const int8_t *wavetable;
+// Wave shape selected by SHAPE knob.
+volatile uint8_t shape;
 
 void setup()
 {
   lfoClock.start();
 
   phaseOffset = 0;
-  wavetable = WT_TRIANGLE;
+  shape = SHAPE_TRIANGLE;
+
+  shapeSmoother.reset(analogRead(JNTUB::PIN_PARAM3));
+  phaseSmoother.reset(analogRead(JNTUB::PIN_PARAM2));
+  rateSmoother.reset(analogRead(JNTUB::PIN_PARAM1));
 
   JNTUB::setUpTimerInterrupt(TIMER_RATE);
+  JNTUB::setUpGateInterrupt();
+  edgeTimer.begin();
 
 #ifdef USE_10_BIT_PWM
   // At slow speeds, the 8-bitness of the PWM output becomes quite apparent.
@@ -167,33 +200,40 @@ void setup()
 
 void loop()
 {
-  uint16_t shapeRaw = analogRead(JNTUB::PIN_PARAM3);
-  uint16_t phaseRaw = analogRead(JNTUB::PIN_PARAM2);
-  uint16_t rateRaw = analogRead(JNTUB::PIN_PARAM1);
+  uint16_t shapeRaw = shapeSmoother.update(analogRead(JNTUB::PIN_PARAM3));
+  uint16_t phaseRaw = phaseSmoother.update(analogRead(JNTUB::PIN_PARAM2));
+  uint16_t rateRaw = rateSmoother.update(analogRead(JNTUB::PIN_PARAM1));
+
+  clockFollower.update();
 
   uint32_t rate;
   if (clockDetector.isClock()) {
     // We have determined that the input signal is a clock signal.
     // Synchronize the LFO to this clock signal.
-    uint32_t _duty;
-    clockDetector.getRateAndDuty(&rate, &_duty);
+    noInterrupts();
+    rate = clockFollower.getRate();
+    interrupts();
 
     // Multiply or divide the rate depending on the knob position.
     if (rateRaw < 512) {
       divideKnob.update(1023 - (rateRaw * 2));
       division = MULTIPLIERS[divideKnob.getValue()];
-      rate = rate >> division;
+      rate = rate / division;
     } else {
       multiplyKnob.update((rateRaw - 511) * 2);
-      rate = rate << MULTIPLIERS[multiplyKnob.getValue()];
+      uint8_t multiplier = MULTIPLIERS[multiplyKnob.getValue()];
+      if (rate > UINT32_MAX / multiplier)
+        rate = UINT32_MAX;
+      else
+        rate = rate * multiplier;
 
       division = 0;  // not dividing
     }
   } else {
     // The input signal is not a clock signal. LFO is free-running.
     rateKnob.update(rateRaw);
-    uint32_t periodMicros = rateKnob.getValue();
-    rate = lfoClock.microsToRate(periodMicros);
+    freeRunningRate.update(rateKnob.getValue());
+    rate = freeRunningRate.getValue();
 
     division = 0;  // not in clocked mode
   }
@@ -206,10 +246,15 @@ void loop()
   noInterrupts();
   lfoClock.setRate(rate);
   phaseOffset = phase;
-  wavetable = SHAPES[shapeSelect];
+  shape = shapeSelect;
   interrupts();
 }
 
+ISR(GATE_INTERRUPT)
+{
+  edgeTimer.capture();
+}
+
 ISR(TIMER_INTERRUPT)
 {
   // Re-enable interrupts (they are disabled by default when entering ISRs).
@@ -218,9 +263,12 @@ ISR(TIMER_INTERRUPT)
 
   lfoClock.tick();
 
+  uint8_t elapsed = edgeTimer.elapsed();
   bool gate = digitalRead(JNTUB::PIN_GATE_TRG);
-  clockDetector.tick(gate);
-  if (clockDetector.isRising()) {
+  clockDetector.tick(gate, elapsed);
+  clockFollower.tick(gate, elapsed);
+  // Sync to the follower's periods rather than the raw edges, which jitter.
+  if (clockFollower.isClockRising()) {
     if (++divides >= division) {
       lfoClock.sync();
       divides = 0;
@@ -229,16 +277,29 @@ ISR(TIMER_INTERRUPT)
 
   uint32_t phase = lfoClock.getPhase();
   uint16_t phase10bit = phase >> (JNTUB::FastClock::PHASE_BITS - 10);
-  uint8_t phase8bit = phase10bit >> 2;
-  uint8_t phaseRemainder = phase10bit - ((uint16_t)phase8bit<<2); // 0 to 3
-
-  // Interpolate between wavetable[index] and wavetable[index+1]
-  uint8_t index = phase8bit + phaseOffset;
-  int16_t valueA = (int8_t)pgm_read_byte_near(wavetable + index++) * 4;
-  int16_t valueB = (int8_t)pgm_read_byte_near(wavetable + index) * 4;
-  int16_t difference = valueB - valueA;
-
-  int16_t output = valueA + (difference * (int8_t)phaseRemainder / 4);
+  phase10bit += (uint16_t)phaseOffset << 2;
+
+  // Full 10-bit output: for the sine, interpolate between the two nearest
+  // table values, keeping the bottom two bits of the phase as two extra bits
+  // of output precision.
+  int16_t output;
+  switch (shape) {
+    case SHAPE_SINE:
+      output = SINE.linearExtended<10>(phase10bit);
+      break;
+    case SHAPE_TRIANGLE:
+      output = JNTUB::triangleWave<10>(phase10bit);
+      break;
+    case SHAPE_RAMP:
+      output = JNTUB::rampWave<10>(phase10bit);
+      break;
+    case SHAPE_SAWTOOTH:
+      output = JNTUB::sawWave<10>(phase10bit);
+      break;
+    default:
+      output = JNTUB::squareWave<10>(phase10bit);
+      break;
+  }
 
 #ifdef USE_10_BIT_PWM
   JNTUB::analogWriteOutPrecise(output + 512);
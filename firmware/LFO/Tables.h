@@ -22,1300 +22,15 @@
 
  */
 
-#include <avr/pgmspace.h>
-#include <stdint.h>
+// JoyfulNoise Tiny Utility Board Library
+#include <JNTUB.h>
 
-const int8_t WT_SINE[256] PROGMEM = {
-  0,  // 0
-  3,  // 1
-  6,  // 2
-  9,  // 3
-  12,  // 4
-  15,  // 5
-  18,  // 6
-  21,  // 7
-  24,  // 8
-  27,  // 9
-  30,  // 10
-  34,  // 11
-  37,  // 12
-  39,  // 13
-  42,  // 14
-  45,  // 15
-  48,  // 16
-  51,  // 17
-  54,  // 18
-  57,  // 19
-  60,  // 20
-  62,  // 21
-  65,  // 22
-  68,  // 23
-  70,  // 24
-  73,  // 25
-  75,  // 26
-  78,  // 27
-  80,  // 28
-  83,  // 29
-  85,  // 30
-  87,  // 31
-  90,  // 32
-  92,  // 33
-  94,  // 34
-  96,  // 35
-  98,  // 36
-  100,  // 37
-  102,  // 38
-  104,  // 39
-  106,  // 40
-  107,  // 41
-  109,  // 42
-  110,  // 43
-  112,  // 44
-  113,  // 45
-  115,  // 46
-  116,  // 47
-  117,  // 48
-  118,  // 49
-  120,  // 50
-  121,  // 51
-  122,  // 52
-  122,  // 53
-  123,  // 54
-  124,  // 55
-  125,  // 56
-  125,  // 57
-  126,  // 58
-  126,  // 59
-  126,  // 60
-  127,  // 61
-  127,  // 62
-  127,  // 63
-  127,  // 64
-  127,  // 65
-  127,  // 66
-  127,  // 67
-  126,  // 68
-  126,  // 69
-  126,  // 70
-  125,  // 71
-  125,  // 72
-  124,  // 73
-  123,  // 74
-  122,  // 75
-  122,  // 76
-  121,  // 77
-  120,  // 78
-  118,  // 79
-  117,  // 80
-  116,  // 81
-  115,  // 82
-  113,  // 83
-  112,  // 84
-  110,  // 85
-  109,  // 86
-  107,  // 87
-  106,  // 88
-  104,  // 89
-  102,  // 90
-  100,  // 91
-  98,  // 92
-  96,  // 93
-  94,  // 94
-  92,  // 95
-  90,  // 96
-  87,  // 97
-  85,  // 98
-  83,  // 99
-  80,  // 100
-  78,  // 101
-  75,  // 102
-  73,  // 103
-  70,  // 104
-  68,  // 105
-  65,  // 106
-  62,  // 107
-  60,  // 108
-  57,  // 109
-  54,  // 110
-  51,  // 111
-  48,  // 112
-  45,  // 113
-  42,  // 114
-  39,  // 115
-  37,  // 116
-  34,  // 117
-  30,  // 118
-  27,  // 119
-  24,  // 120
-  21,  // 121
-  18,  // 122
-  15,  // 123
-  12,  // 124
-  9,  // 125
-  6,  // 126
-  3,  // 127
-  0,  // 128
-  -4,  // 129
-  -7,  // 130
-  -10,  // 131
-  -13,  // 132
-  -16,  // 133
-  -19,  // 134
-  -22,  // 135
-  -25,  // 136
-  -28,  // 137
-  -31,  // 138
-  -35,  // 139
-  -38,  // 140
-  -40,  // 141
-  -43,  // 142
-  -46,  // 143
-  -49,  // 144
-  -52,  // 145
-  -55,  // 146
-  -58,  // 147
-  -61,  // 148
-  -63,  // 149
-  -66,  // 150
-  -69,  // 151
-  -71,  // 152
-  -74,  // 153
-  -76,  // 154
-  -79,  // 155
-  -81,  // 156
-  -84,  // 157
-  -86,  // 158
-  -88,  // 159
-  -91,  // 160
-  -93,  // 161
-  -95,  // 162
-  -97,  // 163
-  -99,  // 164
-  -101,  // 165
-  -103,  // 166
-  -105,  // 167
-  -107,  // 168
-  -108,  // 169
-  -110,  // 170
-  -111,  // 171
-  -113,  // 172
-  -114,  // 173
-  -116,  // 174
-  -117,  // 175
-  -118,  // 176
-  -119,  // 177
-  -121,  // 178
-  -122,  // 179
-  -123,  // 180
-  -123,  // 181
-  -124,  // 182
-  -125,  // 183
-  -126,  // 184
-  -126,  // 185
-  -127,  // 186
-  -127,  // 187
-  -127,  // 188
-  -128,  // 189
-  -128,  // 190
-  -128,  // 191
-  -128,  // 192
-  -128,  // 193
-  -128,  // 194
-  -128,  // 195
-  -127,  // 196
-  -127,  // 197
-  -127,  // 198
-  -126,  // 199
-  -126,  // 200
-  -125,  // 201
-  -124,  // 202
-  -123,  // 203
-  -123,  // 204
-  -122,  // 205
-  -121,  // 206
-  -119,  // 207
-  -118,  // 208
-  -117,  // 209
-  -116,  // 210
-  -114,  // 211
-  -113,  // 212
-  -111,  // 213
-  -110,  // 214
-  -108,  // 215
-  -107,  // 216
-  -105,  // 217
-  -103,  // 218
-  -101,  // 219
-  -99,  // 220
-  -97,  // 221
-  -95,  // 222
-  -93,  // 223
-  -91,  // 224
-  -88,  // 225
-  -86,  // 226
-  -84,  // 227
-  -81,  // 228
-  -79,  // 229
-  -76,  // 230
-  -74,  // 231
-  -71,  // 232
-  -69,  // 233
-  -66,  // 234
-  -63,  // 235
-  -61,  // 236
-  -58,  // 237
-  -55,  // 238
-  -52,  // 239
-  -49,  // 240
-  -46,  // 241
-  -43,  // 242
-  -40,  // 243
-  -38,  // 244
-  -35,  // 245
-  -31,  // 246
-  -28,  // 247
-  -25,  // 248
-  -22,  // 249
-  -19,  // 250
-  -16,  // 251
-  -13,  // 252
-  -10,  // 253
-  -7,  // 254
-  -4,  // 255
-};
-
-const int8_t WT_TRIANGLE[256] PROGMEM = {
-  0,  //0
-  1,  //1
-  3,  //2
-  5,  //3
-  7,  //4
-  9,  //5
-  11,  //6
-  13,  //7
-  15,  //8
-  17,  //9
-  19,  //10
-  21,  //11
-  23,  //12
-  25,  //13
-  27,  //14
-  29,  //15
-  31,  //16
-  33,  //17
-  35,  //18
-  37,  //19
-  39,  //20
-  41,  //21
-  43,  //22
-  45,  //23
-  47,  //24
-  49,  //25
-  51,  //26
-  53,  //27
-  55,  //28
-  57,  //29
-  59,  //30
-  61,  //31
-  63,  //32
-  65,  //33
-  67,  //34
-  69,  //35
-  71,  //36
-  73,  //37
-  75,  //38
-  77,  //39
-  79,  //40
-  81,  //41
-  83,  //42
-  85,  //43
-  87,  //44
-  89,  //45
-  91,  //46
-  93,  //47
-  95,  //48
-  97,  //49
-  99,  //50
-  101,  //51
-  103,  //52
-  105,  //53
-  107,  //54
-  109,  //55
-  111,  //56
-  113,  //57
-  115,  //58
-  117,  //59
-  119,  //60
-  121,  //61
-  123,  //62
-  125,  //63
-  127,  //64
-  125,  //65
-  123,  //66
-  121,  //67
-  119,  //68
-  117,  //69
-  115,  //70
-  113,  //71
-  111,  //72
-  109,  //73
-  107,  //74
-  105,  //75
-  103,  //76
-  101,  //77
-  99,  //78
-  97,  //79
-  95,  //80
-  93,  //81
-  91,  //82
-  89,  //83
-  87,  //84
-  85,  //85
-  83,  //86
-  81,  //87
-  79,  //88
-  77,  //89
-  75,  //90
-  73,  //91
-  71,  //92
-  69,  //93
-  67,  //94
-  65,  //95
-  63,  //96
-  61,  //97
-  59,  //98
-  57,  //99
-  55,  //100
-  53,  //101
-  51,  //102
-  49,  //103
-  47,  //104
-  45,  //105
-  43,  //106
-  41,  //107
-  39,  //108
-  37,  //109
-  35,  //110
-  33,  //111
-  31,  //112
-  29,  //113
-  27,  //114
-  25,  //115
-  23,  //116
-  21,  //117
-  19,  //118
-  17,  //119
-  15,  //120
-  13,  //121
-  11,  //122
-  9,  //123
-  7,  //124
-  5,  //125
-  3,  //126
-  1,  //127
-  0,  //128
-  -1,  //129
-  -3,  //130
-  -5,  //131
-  -7,  //132
-  -9,  //133
-  -11,  //134
-  -13,  //135
-  -15,  //136
-  -17,  //137
-  -19,  //138
-  -21,  //139
-  -23,  //140
-  -25,  //141
-  -27,  //142
-  -29,  //143
-  -31,  //144
-  -33,  //145
-  -35,  //146
-  -37,  //147
-  -39,  //148
-  -41,  //149
-  -43,  //150
-  -45,  //151
-  -47,  //152
-  -49,  //153
-  -51,  //154
-  -53,  //155
-  -55,  //156
-  -57,  //157
-  -59,  //158
-  -61,  //159
-  -63,  //160
-  -65,  //161
-  -67,  //162
-  -69,  //163
-  -71,  //164
-  -73,  //165
-  -75,  //166
-  -77,  //167
-  -79,  //168
-  -81,  //169
-  -83,  //170
-  -85,  //171
-  -87,  //172
-  -89,  //173
-  -91,  //174
-  -93,  //175
-  -95,  //176
-  -97,  //177
-  -99,  //178
-  -101,  //179
-  -103,  //180
-  -105,  //181
-  -107,  //182
-  -109,  //183
-  -111,  //184
-  -113,  //185
-  -115,  //186
-  -117,  //187
-  -119,  //188
-  -121,  //189
-  -123,  //190
-  -125,  //191
-  -127,  //192
-  -125,  //193
-  -123,  //194
-  -121,  //195
-  -119,  //196
-  -117,  //197
-  -115,  //198
-  -113,  //199
-  -111,  //200
-  -109,  //201
-  -107,  //202
-  -105,  //203
-  -103,  //204
-  -101,  //205
-  -99,  //206
-  -97,  //207
-  -95,  //208
-  -93,  //209
-  -91,  //210
-  -89,  //211
-  -87,  //212
-  -85,  //213
-  -83,  //214
-  -81,  //215
-  -79,  //216
-  -77,  //217
-  -75,  //218
-  -73,  //219
-  -71,  //220
-  -69,  //221
-  -67,  //222
-  -65,  //223
-  -63,  //224
-  -61,  //225
-  -59,  //226
-  -57,  //227
-  -55,  //228
-  -53,  //229
-  -51,  //230
-  -49,  //231
-  -47,  //232
-  -45,  //233
-  -43,  //234
-  -41,  //235
-  -39,  //236
-  -37,  //237
-  -35,  //238
-  -33,  //239
-  -31,  //240
-  -29,  //241
-  -27,  //242
-  -25,  //243
-  -23,  //244
-  -21,  //245
-  -19,  //246
-  -17,  //247
-  -15,  //248
-  -13,  //249
-  -11,  //250
-  -9,  //251
-  -7,  //252
-  -5,  //253
-  -3,  //254
-  -2,  //255
-};
-
-const int8_t WT_SAWTOOTH[256] PROGMEM = {
-  127,  // 0
-  126,  // 1
-  125,  // 2
-  124,  // 3
-  123,  // 4
-  122,  // 5
-  121,  // 6
-  120,  // 7
-  119,  // 8
-  118,  // 9
-  117,  // 10
-  116,  // 11
-  115,  // 12
-  114,  // 13
-  113,  // 14
-  112,  // 15
-  111,  // 16
-  110,  // 17
-  109,  // 18
-  108,  // 19
-  107,  // 20
-  106,  // 21
-  105,  // 22
-  104,  // 23
-  103,  // 24
-  102,  // 25
-  101,  // 26
-  100,  // 27
-  99,  // 28
-  98,  // 29
-  97,  // 30
-  96,  // 31
-  95,  // 32
-  94,  // 33
-  93,  // 34
-  92,  // 35
-  91,  // 36
-  90,  // 37
-  89,  // 38
-  88,  // 39
-  87,  // 40
-  86,  // 41
-  85,  // 42
-  84,  // 43
-  83,  // 44
-  82,  // 45
-  81,  // 46
-  80,  // 47
-  79,  // 48
-  78,  // 49
-  77,  // 50
-  76,  // 51
-  75,  // 52
-  74,  // 53
-  73,  // 54
-  72,  // 55
-  71,  // 56
-  70,  // 57
-  69,  // 58
-  68,  // 59
-  67,  // 60
-  66,  // 61
-  65,  // 62
-  64,  // 63
-  63,  // 64
-  62,  // 65
-  61,  // 66
-  60,  // 67
-  59,  // 68
-  58,  // 69
-  57,  // 70
-  56,  // 71
-  55,  // 72
-  54,  // 73
-  53,  // 74
-  52,  // 75
-  51,  // 76
-  50,  // 77
-  49,  // 78
-  48,  // 79
-  47,  // 80
-  46,  // 81
-  45,  // 82
-  44,  // 83
-  43,  // 84
-  42,  // 85
-  41,  // 86
-  40,  // 87
-  39,  // 88
-  38,  // 89
-  37,  // 90
-  36,  // 91
-  35,  // 92
-  34,  // 93
-  33,  // 94
-  32,  // 95
-  31,  // 96
-  30,  // 97
-  29,  // 98
-  28,  // 99
-  27,  // 100
-  26,  // 101
-  25,  // 102
-  24,  // 103
-  23,  // 104
-  22,  // 105
-  21,  // 106
-  20,  // 107
-  19,  // 108
-  18,  // 109
-  17,  // 110
-  16,  // 111
-  15,  // 112
-  14,  // 113
-  13,  // 114
-  12,  // 115
-  11,  // 116
-  10,  // 117
-  9,  // 118
-  8,  // 119
-  7,  // 120
-  6,  // 121
-  5,  // 122
-  4,  // 123
-  3,  // 124
-  2,  // 125
-  1,  // 126
-  0,  // 127
-  -1,  // 128
-  -2,  // 129
-  -3,  // 130
-  -4,  // 131
-  -5,  // 132
-  -6,  // 133
-  -7,  // 134
-  -8,  // 135
-  -9,  // 136
-  -10,  // 137
-  -11,  // 138
-  -12,  // 139
-  -13,  // 140
-  -14,  // 141
-  -15,  // 142
-  -16,  // 143
-  -17,  // 144
-  -18,  // 145
-  -19,  // 146
-  -20,  // 147
-  -21,  // 148
-  -22,  // 149
-  -23,  // 150
-  -24,  // 151
-  -25,  // 152
-  -26,  // 153
-  -27,  // 154
-  -28,  // 155
-  -29,  // 156
-  -30,  // 157
-  -31,  // 158
-  -32,  // 159
-  -33,  // 160
-  -34,  // 161
-  -35,  // 162
-  -36,  // 163
-  -37,  // 164
-  -38,  // 165
-  -39,  // 166
-  -40,  // 167
-  -41,  // 168
-  -42,  // 169
-  -43,  // 170
-  -44,  // 171
-  -45,  // 172
-  -46,  // 173
-  -47,  // 174
-  -48,  // 175
-  -49,  // 176
-  -50,  // 177
-  -51,  // 178
-  -52,  // 179
-  -53,  // 180
-  -54,  // 181
-  -55,  // 182
-  -56,  // 183
-  -57,  // 184
-  -58,  // 185
-  -59,  // 186
-  -60,  // 187
-  -61,  // 188
-  -62,  // 189
-  -63,  // 190
-  -64,  // 191
-  -65,  // 192
-  -66,  // 193
-  -67,  // 194
-  -68,  // 195
-  -69,  // 196
-  -70,  // 197
-  -71,  // 198
-  -72,  // 199
-  -73,  // 200
-  -74,  // 201
-  -75,  // 202
-  -76,  // 203
-  -77,  // 204
-  -78,  // 205
-  -79,  // 206
-  -80,  // 207
-  -81,  // 208
-  -82,  // 209
-  -83,  // 210
-  -84,  // 211
-  -85,  // 212
-  -86,  // 213
-  -87,  // 214
-  -88,  // 215
-  -89,  // 216
-  -90,  // 217
-  -91,  // 218
-  -92,  // 219
-  -93,  // 220
-  -94,  // 221
-  -95,  // 222
-  -96,  // 223
-  -97,  // 224
-  -98,  // 225
-  -99,  // 226
-  -100,  // 227
-  -101,  // 228
-  -102,  // 229
-  -103,  // 230
-  -104,  // 231
-  -105,  // 232
-  -106,  // 233
-  -107,  // 234
-  -108,  // 235
-  -109,  // 236
-  -110,  // 237
-  -111,  // 238
-  -112,  // 239
-  -113,  // 240
-  -114,  // 241
-  -115,  // 242
-  -116,  // 243
-  -117,  // 244
-  -118,  // 245
-  -119,  // 246
-  -120,  // 247
-  -121,  // 248
-  -122,  // 249
-  -123,  // 250
-  -124,  // 251
-  -125,  // 252
-  -126,  // 253
-  -127,  // 254
-  -128,  // 255
-};
-
-const int8_t WT_SQUARE[256] PROGMEM = {
-  127,  // 0
-  127,  // 1
-  127,  // 2
-  127,  // 3
-  127,  // 4
-  127,  // 5
-  127,  // 6
-  127,  // 7
-  127,  // 8
-  127,  // 9
-  127,  // 10
-  127,  // 11
-  127,  // 12
-  127,  // 13
-  127,  // 14
-  127,  // 15
-  127,  // 16
-  127,  // 17
-  127,  // 18
-  127,  // 19
-  127,  // 20
-  127,  // 21
-  127,  // 22
-  127,  // 23
-  127,  // 24
-  127,  // 25
-  127,  // 26
-  127,  // 27
-  127,  // 28
-  127,  // 29
-  127,  // 30
-  127,  // 31
-  127,  // 32
-  127,  // 33
-  127,  // 34
-  127,  // 35
-  127,  // 36
-  127,  // 37
-  127,  // 38
-  127,  // 39
-  127,  // 40
-  127,  // 41
-  127,  // 42
-  127,  // 43
-  127,  // 44
-  127,  // 45
-  127,  // 46
-  127,  // 47
-  127,  // 48
-  127,  // 49
-  127,  // 50
-  127,  // 51
-  127,  // 52
-  127,  // 53
-  127,  // 54
-  127,  // 55
-  127,  // 56
-  127,  // 57
-  127,  // 58
-  127,  // 59
-  127,  // 60
-  127,  // 61
-  127,  // 62
-  127,  // 63
-  127,  // 64
-  127,  // 65
-  127,  // 66
-  127,  // 67
-  127,  // 68
-  127,  // 69
-  127,  // 70
-  127,  // 71
-  127,  // 72
-  127,  // 73
-  127,  // 74
-  127,  // 75
-  127,  // 76
-  127,  // 77
-  127,  // 78
-  127,  // 79
-  127,  // 80
-  127,  // 81
-  127,  // 82
-  127,  // 83
-  127,  // 84
-  127,  // 85
-  127,  // 86
-  127,  // 87
-  127,  // 88
-  127,  // 89
-  127,  // 90
-  127,  // 91
-  127,  // 92
-  127,  // 93
-  127,  // 94
-  127,  // 95
-  127,  // 96
-  127,  // 97
-  127,  // 98
-  127,  // 99
-  127,  // 100
-  127,  // 101
-  127,  // 102
-  127,  // 103
-  127,  // 104
-  127,  // 105
-  127,  // 106
-  127,  // 107
-  127,  // 108
-  127,  // 109
-  127,  // 110
-  127,  // 111
-  127,  // 112
-  127,  // 113
-  127,  // 114
-  127,  // 115
-  127,  // 116
-  127,  // 117
-  127,  // 118
-  127,  // 119
-  127,  // 120
-  127,  // 121
-  127,  // 122
-  127,  // 123
-  127,  // 124
-  127,  // 125
-  127,  // 126
-  127,  // 127
-  -128,  // 128
-  -128,  // 129
-  -128,  // 130
-  -128,  // 131
-  -128,  // 132
-  -128,  // 133
-  -128,  // 134
-  -128,  // 135
-  -128,  // 136
-  -128,  // 137
-  -128,  // 138
-  -128,  // 139
-  -128,  // 140
-  -128,  // 141
-  -128,  // 142
-  -128,  // 143
-  -128,  // 144
-  -128,  // 145
-  -128,  // 146
-  -128,  // 147
-  -128,  // 148
-  -128,  // 149
-  -128,  // 150
-  -128,  // 151
-  -128,  // 152
-  -128,  // 153
-  -128,  // 154
-  -128,  // 155
-  -128,  // 156
-  -128,  // 157
-  -128,  // 158
-  -128,  // 159
-  -128,  // 160
-  -128,  // 161
-  -128,  // 162
-  -128,  // 163
-  -128,  // 164
-  -128,  // 165
-  -128,  // 166
-  -128,  // 167
-  -128,  // 168
-  -128,  // 169
-  -128,  // 170
-  -128,  // 171
-  -128,  // 172
-  -128,  // 173
-  -128,  // 174
-  -128,  // 175
-  -128,  // 176
-  -128,  // 177
-  -128,  // 178
-  -128,  // 179
-  -128,  // 180
-  -128,  // 181
-  -128,  // 182
-  -128,  // 183
-  -128,  // 184
-  -128,  // 185
-  -128,  // 186
-  -128,  // 187
-  -128,  // 188
-  -128,  // 189
-  -128,  // 190
-  -128,  // 191
-  -128,  // 192
-  -128,  // 193
-  -128,  // 194
-  -128,  // 195
-  -128,  // 196
-  -128,  // 197
-  -128,  // 198
-  -128,  // 199
-  -128,  // 200
-  -128,  // 201
-  -128,  // 202
-  -128,  // 203
-  -128,  // 204
-  -128,  // 205
-  -128,  // 206
-  -128,  // 207
-  -128,  // 208
-  -128,  // 209
-  -128,  // 210
-  -128,  // 211
-  -128,  // 212
-  -128,  // 213
-  -128,  // 214
-  -128,  // 215
-  -128,  // 216
-  -128,  // 217
-  -128,  // 218
-  -128,  // 219
-  -128,  // 220
-  -128,  // 221
-  -128,  // 222
-  -128,  // 223
-  -128,  // 224
-  -128,  // 225
-  -128,  // 226
-  -128,  // 227
-  -128,  // 228
-  -128,  // 229
-  -128,  // 230
-  -128,  // 231
-  -128,  // 232
-  -128,  // 233
-  -128,  // 234
-  -128,  // 235
-  -128,  // 236
-  -128,  // 237
-  -128,  // 238
-  -128,  // 239
-  -128,  // 240
-  -128,  // 241
-  -128,  // 242
-  -128,  // 243
-  -128,  // 244
-  -128,  // 245
-  -128,  // 246
-  -128,  // 247
-  -128,  // 248
-  -128,  // 249
-  -128,  // 250
-  -128,  // 251
-  -128,  // 252
-  -128,  // 253
-  -128,  // 254
-  -128,  // 255
-};
+/**
+ * Sine wave. Only a quarter of it is stored (entries 0 to 64 of 256); the rest
+ * is rebuilt from symmetry. The other shapes are computed on the fly.
+ */
+typedef JNTUB::ProgmemTable<
+  int8_t, 256, JNTUB::TABLE_WRAP, JNTUB::TABLE_QUARTER_WAVE> SineTable;
 
-const int8_t WT_RAMP[256] PROGMEM = {
-  -128,  // 0
-  -127,  // 1
-  -126,  // 2
-  -125,  // 3
-  -124,  // 4
-  -123,  // 5
-  -122,  // 6
-  -121,  // 7
-  -120,  // 8
-  -119,  // 9
-  -118,  // 10
-  -117,  // 11
-  -116,  // 12
-  -115,  // 13
-  -114,  // 14
-  -113,  // 15
-  -112,  // 16
-  -111,  // 17
-  -110,  // 18
-  -109,  // 19
-  -108,  // 20
-  -107,  // 21
-  -106,  // 22
-  -105,  // 23
-  -104,  // 24
-  -103,  // 25
-  -102,  // 26
-  -101,  // 27
-  -100,  // 28
-  -99,  // 29
-  -98,  // 30
-  -97,  // 31
-  -96,  // 32
-  -95,  // 33
-  -94,  // 34
-  -93,  // 35
-  -92,  // 36
-  -91,  // 37
-  -90,  // 38
-  -89,  // 39
-  -88,  // 40
-  -87,  // 41
-  -86,  // 42
-  -85,  // 43
-  -84,  // 44
-  -83,  // 45
-  -82,  // 46
-  -81,  // 47
-  -80,  // 48
-  -79,  // 49
-  -78,  // 50
-  -77,  // 51
-  -76,  // 52
-  -75,  // 53
-  -74,  // 54
-  -73,  // 55
-  -72,  // 56
-  -71,  // 57
-  -70,  // 58
-  -69,  // 59
-  -68,  // 60
-  -67,  // 61
-  -66,  // 62
-  -65,  // 63
-  -64,  // 64
-  -63,  // 65
-  -62,  // 66
-  -61,  // 67
-  -60,  // 68
-  -59,  // 69
-  -58,  // 70
-  -57,  // 71
-  -56,  // 72
-  -55,  // 73
-  -54,  // 74
-  -53,  // 75
-  -52,  // 76
-  -51,  // 77
-  -50,  // 78
-  -49,  // 79
-  -48,  // 80
-  -47,  // 81
-  -46,  // 82
-  -45,  // 83
-  -44,  // 84
-  -43,  // 85
-  -42,  // 86
-  -41,  // 87
-  -40,  // 88
-  -39,  // 89
-  -38,  // 90
-  -37,  // 91
-  -36,  // 92
-  -35,  // 93
-  -34,  // 94
-  -33,  // 95
-  -32,  // 96
-  -31,  // 97
-  -30,  // 98
-  -29,  // 99
-  -28,  // 100
-  -27,  // 101
-  -26,  // 102
-  -25,  // 103
-  -24,  // 104
-  -23,  // 105
-  -22,  // 106
-  -21,  // 107
-  -20,  // 108
-  -19,  // 109
-  -18,  // 110
-  -17,  // 111
-  -16,  // 112
-  -15,  // 113
-  -14,  // 114
-  -13,  // 115
-  -12,  // 116
-  -11,  // 117
-  -10,  // 118
-  -9,  // 119
-  -8,  // 120
-  -7,  // 121
-  -6,  // 122
-  -5,  // 123
-  -4,  // 124
-  -3,  // 125
-  -2,  // 126
-  -1,  // 127
-  0,  // 128
-  1,  // 129
-  2,  // 130
-  3,  // 131
-  4,  // 132
-  5,  // 133
-  6,  // 134
-  7,  // 135
-  8,  // 136
-  9,  // 137
-  10,  // 138
-  11,  // 139
-  12,  // 140
-  13,  // 141
-  14,  // 142
-  15,  // 143
-  16,  // 144
-  17,  // 145
-  18,  // 146
-  19,  // 147
-  20,  // 148
-  21,  // 149
-  22,  // 150
-  23,  // 151
-  24,  // 152
-  25,  // 153
-  26,  // 154
-  27,  // 155
-  28,  // 156
-  29,  // 157
-  30,  // 158
-  31,  // 159
-  32,  // 160
-  33,  // 161
-  34,  // 162
-  35,  // 163
-  36,  // 164
-  37,  // 165
-  38,  // 166
-  39,  // 167
-  40,  // 168
-  41,  // 169
-  42,  // 170
-  43,  // 171
-  44,  // 172
-  45,  // 173
-  46,  // 174
-  47,  // 175
-  48,  // 176
-  49,  // 177
-  50,  // 178
-  51,  // 179
-  52,  // 180
-  53,  // 181
-  54,  // 182
-  55,  // 183
-  56,  // 184
-  57,  // 185
-  58,  // 186
-  59,  // 187
-  60,  // 188
-  61,  // 189
-  62,  // 190
-  63,  // 191
-  64,  // 192
-  65,  // 193
-  66,  // 194
-  67,  // 195
-  68,  // 196
-  69,  // 197
-  70,  // 198
-  71,  // 199
-  72,  // 200
-  73,  // 201
-  74,  // 202
-  75,  // 203
-  76,  // 204
-  77,  // 205
-  78,  // 206
-  79,  // 207
-  80,  // 208
-  81,  // 209
-  82,  // 210
-  83,  // 211
-  84,  // 212
-  85,  // 213
-  86,  // 214
-  87,  // 215
-  88,  // 216
-  89,  // 217
-  90,  // 218
-  91,  // 219
-  92,  // 220
-  93,  // 221
-  94,  // 222
-  95,  // 223
-  96,  // 224
-  97,  // 225
-  98,  // 226
-  99,  // 227
-  100,  // 228
-  101,  // 229
-  102,  // 230
-  103,  // 231
-  104,  // 232
-  105,  // 233
-  106,  // 234
-  107,  // 235
-  108,  // 236
-  109,  // 237
-  110,  // 238
-  111,  // 239
-  112,  // 240
-  113,  // 241
-  114,  // 242
-  115,  // 243
-  116,  // 244
-  117,  // 245
-  118,  // 246
-  119,  // 247
-  120,  // 248
-  121,  // 249
-  122,  // 250
-  123,  // 251
-  124,  // 252
-  125,  // 253
-  126,  // 254
-  127,  // 255
-};
+const int8_t *const WT_SINE_QUARTER = JNTUB::GeneratedTable<
+  JNTUB::SineWave<int8_t, 256>, SineTable::STORED_SIZE>::DATA;
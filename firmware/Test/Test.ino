@@ -29,7 +29,7 @@
 #define REPORT_RATE 500L
 unsigned long nextReport = 0;
 
-JNTUB::DiscreteKnob knob1(2, 10);
+JNTUB::DiscreteKnob<> knob1(2, 10);
 JNTUB::Clock clock;
 bool prevGate;
 